@@ -0,0 +1,87 @@
+#ifndef KOLIBRI_SRC_LINE_INDEX_H_
+#define KOLIBRI_SRC_LINE_INDEX_H_
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lexer/lexer_simd.h"
+
+namespace base {
+// A position in a source. Line and column start at 1, the column counts bytes.
+struct SourceLocation {
+  size_t line;
+  size_t column;
+};
+
+// Maps pointers and offsets into a source to lines and columns. Tokens only store their value, so
+// nothing is tracked while lexing. The line starts are collected by one scan over the source when
+// the first location is requested.
+class LineIndex {
+ public:
+  explicit LineIndex(std::string_view source) : source_(source), line_starts_(), once_() {}
+
+  LineIndex(LineIndex const&) = delete;
+  LineIndex& operator=(LineIndex const&) = delete;
+
+  // True when ptr points into the source or to its end.
+  bool Contains(const char* ptr) const { return (ptr >= source_.data()) && (ptr <= source_.data() + source_.size()); }
+
+  SourceLocation Locate(size_t offset) const {
+    const std::vector<size_t>& starts = GetLineStarts();
+    offset = std::min(offset, source_.size());
+    size_t line = static_cast<size_t>(std::upper_bound(starts.begin(), starts.end(), offset) - starts.begin());
+    return {line, offset - starts[line - 1] + 1};
+  }
+
+  SourceLocation Locate(const char* ptr) const { return Locate(static_cast<size_t>(ptr - source_.data())); }
+
+  // The given line without its line break.
+  std::string_view GetLine(size_t line) const {
+    const std::vector<size_t>& starts = GetLineStarts();
+    if ((line == 0) || (line > starts.size())) {
+      return std::string_view();
+    }
+    size_t begin = starts[line - 1];
+    size_t end = line < starts.size() ? starts[line] - 1 : source_.size();
+    return source_.substr(begin, end - begin);
+  }
+
+  size_t NumLines() const { return GetLineStarts().size(); }
+
+  // Formats a diagnostic like "name:line:column: message". The location is left out when ptr is
+  // not inside the source.
+  std::string Format(std::string_view name, const char* ptr, std::string_view message) const {
+    std::string result(name);
+    if (Contains(ptr)) {
+      auto location = Locate(ptr);
+      result += ":" + std::to_string(location.line) + ":" + std::to_string(location.column);
+    }
+    result += ": ";
+    result += message;
+    return result;
+  }
+
+ private:
+  const std::vector<size_t>& GetLineStarts() const {
+    std::call_once(once_, [this]() {
+      const char* begin = source_.data();
+      const char* end = begin + source_.size();
+      line_starts_.push_back(0);
+      for (const char* it = lexer::simd::FindByte(begin, end, '\n'); it != end; it = lexer::simd::FindByte(it + 1, end, '\n')) {
+        line_starts_.push_back(static_cast<size_t>(it + 1 - begin));
+      }
+    });
+    return line_starts_;
+  }
+
+  std::string_view source_;
+  mutable std::vector<size_t> line_starts_;
+  mutable std::once_flag once_;
+};
+}  // namespace base
+#endif
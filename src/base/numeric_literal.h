@@ -0,0 +1,48 @@
+#ifndef KOLIBRI_SRC_NUMERIC_LITERAL_H_
+#define KOLIBRI_SRC_NUMERIC_LITERAL_H_
+
+#include <stdint.h>
+
+#include <charconv>
+#include <string_view>
+#include <system_error>
+
+namespace base {
+// Decoding of numeric literals. The whole text has to be the literal. Nothing is allocated and
+// the locale is not used. Errors are returned, no exception is thrown.
+enum class LiteralStatus {
+  kOk,
+  kMalformed,
+  kOutOfRange
+};
+
+inline const char* ToString(LiteralStatus status) {
+  switch (status) {
+    case LiteralStatus::kOk:
+      return "Ok";
+    case LiteralStatus::kMalformed:
+      return "Malformed literal";
+    case LiteralStatus::kOutOfRange:
+      return "Literal out of range";
+  }
+  return "";
+}
+
+template <typename T>
+LiteralStatus ParseNumber(std::string_view text, T& value) {
+  const char* end = text.data() + text.size();
+  auto result = std::from_chars(text.data(), end, value);
+  if (result.ec == std::errc::result_out_of_range) {
+    return LiteralStatus::kOutOfRange;
+  }
+  if ((result.ec != std::errc()) || (result.ptr != end)) {
+    return LiteralStatus::kMalformed;
+  }
+  return LiteralStatus::kOk;
+}
+
+inline LiteralStatus ParseInteger(std::string_view text, int64_t& value) { return ParseNumber(text, value); }
+
+inline LiteralStatus ParseReal(std::string_view text, double& value) { return ParseNumber(text, value); }
+}  // namespace base
+#endif
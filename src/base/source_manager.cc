@@ -0,0 +1,70 @@
+#include "base/source_manager.h"
+
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define KOLIBRI_BASE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace base {
+
+SourceBuffer::SourceBuffer(std::string name, const char* data, size_t size, bool mapped)
+    : name_(std::move(name)), content_(), data_(data), size_(size), mapped_(mapped), line_index_(std::string_view(data_, size_)) {}
+
+SourceBuffer::SourceBuffer(std::string name, std::string content)
+    : name_(std::move(name)),
+      content_(std::move(content)),
+      data_(content_.data()),
+      size_(content_.size()),
+      mapped_(false),
+      line_index_(std::string_view(data_, size_)) {}
+
+SourceBuffer::~SourceBuffer() {
+#if defined(KOLIBRI_BASE_MMAP)
+  if (mapped_) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+#endif
+}
+
+SourceManager::buffer_type SourceManager::Load(const std::string& filename) {
+#if defined(KOLIBRI_BASE_MMAP)
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat file_stat;
+  if ((fstat(fd, &file_stat) == 0) && S_ISREG(file_stat.st_mode) && (file_stat.st_size > 0)) {
+    size_t size = static_cast<size_t>(file_stat.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+      close(fd);
+      buffer_type buffer(new SourceBuffer(filename, static_cast<const char*>(data), size, true));
+      buffers_.push_back(buffer);
+      return buffer;
+    }
+  }
+  close(fd);  // empty files, pipes etc. are read below
+#endif
+
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.is_open()) {
+    return nullptr;
+  }
+  std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  return AddString(filename, std::move(content));
+}
+
+SourceManager::buffer_type SourceManager::AddString(const std::string& name, std::string content) {
+  buffer_type buffer(new SourceBuffer(name, std::move(content)));
+  buffers_.push_back(buffer);
+  return buffer;
+}
+
+}  // namespace base
@@ -0,0 +1,69 @@
+#ifndef KOLIBRI_SRC_SOURCE_MANAGER_H_
+#define KOLIBRI_SRC_SOURCE_MANAGER_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/line_index.h"
+
+namespace base {
+// A read-only source buffer. Files are memory mapped where the platform allows it, so no copy of
+// the content is made. The pointers of a buffer stay valid as long as the buffer is alive.
+class SourceBuffer {
+ public:
+  ~SourceBuffer();
+
+  SourceBuffer(SourceBuffer const&) = delete;
+  SourceBuffer& operator=(SourceBuffer const&) = delete;
+
+  const char* begin() const { return data_; }
+  const char* end() const { return data_ + size_; }
+  size_t size() const { return size_; }
+  const std::string& GetName() const { return name_; }
+  bool IsMapped() const { return mapped_; }
+
+  // Lines and columns of the buffer, the index is built when it is used the first time.
+  const LineIndex& GetLineIndex() const { return line_index_; }
+
+ private:
+  friend class SourceManager;
+
+  SourceBuffer(std::string name, const char* data, size_t size, bool mapped);
+  SourceBuffer(std::string name, std::string content);
+
+  std::string name_;
+  std::string content_;  // only used when the buffer is not mapped
+  const char* data_;
+  size_t size_;
+  bool mapped_;
+  LineIndex line_index_;
+};
+
+// The SourceManager owns all source buffers of a run. Tokens and AST nodes point into these
+// buffers, so the manager (or a shared_ptr to a buffer) has to outlive them.
+class SourceManager {
+ public:
+  using buffer_type = std::shared_ptr<const SourceBuffer>;
+
+  SourceManager() : buffers_() {}
+
+  SourceManager(SourceManager const&) = delete;
+  SourceManager& operator=(SourceManager const&) = delete;
+
+  // Maps the file read-only. Falls back to reading the file when it can't be mapped. Returns
+  // nullptr when the file can't be opened.
+  buffer_type Load(const std::string& filename);
+
+  // Adds a buffer which is given in memory, e.g. for tests or interactive input.
+  buffer_type AddString(const std::string& name, std::string content);
+
+  size_t NumBuffers() const { return buffers_.size(); }
+
+ private:
+  std::vector<buffer_type> buffers_;
+};
+}  // namespace base
+#endif
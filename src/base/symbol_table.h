@@ -0,0 +1,119 @@
+#ifndef KOLIBRI_SRC_SYMBOL_TABLE_H_
+#define KOLIBRI_SRC_SYMBOL_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "lexer/lexer_char_class.h"
+
+namespace base {
+// Interns identifiers case-insensitively and gives each one a dense id, starting at 0 in the order
+// of interning. Identifiers which differ only in the case of ASCII letters get the same id. Looking
+// up an identifier folds and hashes it on the fly, so nothing is allocated when it is known.
+class SymbolTable {
+ public:
+  using symbol_type = uint32_t;
+
+  static constexpr symbol_type kNoSymbol = UINT32_MAX;
+
+  SymbolTable() : names_(), hashes_(), slots_(kInitialSlots, kEmpty) {}
+
+  SymbolTable(SymbolTable const&) = delete;
+  SymbolTable& operator=(SymbolTable const&) = delete;
+
+  // Returns the id of name and adds it when it is not known yet.
+  symbol_type Intern(std::string_view name) {
+    uint32_t hash = Hash(name);
+    size_t slot = FindSlot(name, hash);
+    if (slots_[slot] != kEmpty) {
+      return slots_[slot];
+    }
+
+    symbol_type symbol = static_cast<symbol_type>(names_.size());
+    std::string folded(name);
+    for (char& ch : folded) {
+      ch = Fold(ch);
+    }
+    names_.push_back(std::move(folded));
+    hashes_.push_back(hash);
+    slots_[slot] = symbol;
+
+    if (names_.size() * 2 > slots_.size()) {  // keep the load factor below 1/2
+      Grow();
+    }
+    return symbol;
+  }
+
+  // Returns the id of name or kNoSymbol when it is not known.
+  symbol_type Find(std::string_view name) const {
+    size_t slot = FindSlot(name, Hash(name));
+    return slots_[slot];
+  }
+
+  // The name in lower case.
+  const std::string& GetName(symbol_type symbol) const { return names_[symbol]; }
+
+  size_t size() const { return names_.size(); }
+
+ private:
+  static constexpr symbol_type kEmpty = kNoSymbol;
+  static constexpr size_t kInitialSlots = 64;
+
+  static char Fold(char ch) { return lexer::kLowerCaseFold[static_cast<unsigned char>(ch)]; }
+
+  // FNV-1a over the folded name
+  static uint32_t Hash(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char ch : name) {
+      hash = (hash ^ static_cast<unsigned char>(Fold(ch))) * 16777619u;
+    }
+    return hash;
+  }
+
+  bool Equals(symbol_type symbol, std::string_view name, uint32_t hash) const {
+    const std::string& known = names_[symbol];
+    if ((hashes_[symbol] != hash) || (known.size() != name.size())) {
+      return false;
+    }
+    for (size_t i = 0; i < name.size(); ++i) {
+      if (known[i] != Fold(name[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // The slot of name or the empty slot where it belongs. Linear probing.
+  size_t FindSlot(std::string_view name, uint32_t hash) const {
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+      if ((slots_[slot] == kEmpty) || Equals(slots_[slot], name, hash)) {
+        return slot;
+      }
+    }
+  }
+
+  void Grow() {
+    std::vector<symbol_type> slots(slots_.size() * 2, kEmpty);
+    size_t mask = slots.size() - 1;
+    for (symbol_type symbol = 0; symbol < names_.size(); ++symbol) {
+      size_t slot = hashes_[symbol] & mask;
+      while (slots[slot] != kEmpty) {
+        slot = (slot + 1) & mask;
+      }
+      slots[slot] = symbol;
+    }
+    slots_ = std::move(slots);
+  }
+
+  std::vector<std::string> names_;
+  std::vector<uint32_t> hashes_;
+  std::vector<symbol_type> slots_;  // power of two
+};
+}  // namespace base
+#endif
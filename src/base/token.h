@@ -13,34 +13,31 @@ class Token {
   using id_type = TId;
 
   // construct token with Unknown id and no value
-  explicit Token() : id_(id_type::kUnknown), value_() {}
+  constexpr explicit Token() : id_(id_type::kUnknown), value_() {}
 
   // construct token with id and no value
-  explicit Token(id_type id) : id_(id), value_() {}
+  constexpr explicit Token(id_type id) : id_(id), value_() {}
 
   // construct token with id. The value of the token is given by its begin ptr and its length len.
-  explicit Token(id_type id, const char* begin, size_t len) : id_(id), value_(begin, len) {}
+  constexpr explicit Token(id_type id, const char* begin, size_t len) : id_(id), value_(begin, len) {}
 
   // construct token with id. The value of the token is given by its begin pointer and its end pointer.
-  explicit Token(id_type id, const char* begin, const char* end) : Token(id, begin, std::distance(begin, end)) {}
+  constexpr explicit Token(id_type id, const char* begin, const char* end) : Token(id, begin, std::distance(begin, end)) {}
 
-  Token(Token const& rhs) : id_(rhs.id_), value_(rhs.value_) {}
-  Token& operator=(Token rhs) {
-    std::swap(value_, rhs.value_);
-    std::swap(id_, rhs.id_);
-    return *this;
-  }
+  // tokens are trivially copyable
+  Token(Token const& rhs) = default;
+  Token& operator=(Token const& rhs) = default;
 
-  bool operator==(const Token& rhs) const { return (id_ == rhs.id_) && (value_ == rhs.value_); }
-  bool operator!=(const Token& rhs) const { return !(*this == rhs); }
+  constexpr bool operator==(const Token& rhs) const { return (id_ == rhs.id_) && (value_ == rhs.value_); }
+  constexpr bool operator!=(const Token& rhs) const { return !(*this == rhs); }
 
-  id_type GetId() const { return id_; }
+  constexpr id_type GetId() const { return id_; }
 
   const char* GetStringId() const {
     return TIdConverter::ToString(id_);
   }
 
-  std::string_view GetValue() const { return value_; }
+  constexpr std::string_view GetValue() const { return value_; }
 
  private:
   //friend std::ostream& ::operator<<(std::ostream& os, const Token& token);
@@ -0,0 +1,44 @@
+#ifndef KOLIBRI_SRC_TOKEN_BUFFER_H_
+#define KOLIBRI_SRC_TOKEN_BUFFER_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+namespace base {
+// The TokenBuffer stores the tokens of an input range in a contiguous vector. The input is
+// consumed once; afterwards the tokens can be visited any number of times through a random
+// access iterator. Backtracking of the parser is therefore just a reset of the iterator.
+template <typename TToken>
+class TokenBuffer {
+ public:
+  using value_type = TToken;
+  using iterator_type = typename std::vector<value_type>::const_iterator;
+
+  TokenBuffer() : tokens_() {}
+
+  // lexes the given range, e.g. lexer.begin() and lexer.end()
+  template <typename TIterator>
+  TokenBuffer(TIterator begin, TIterator end) : tokens_() {
+    Assign(begin, end);
+  }
+
+  template <typename TIterator>
+  void Assign(TIterator begin, TIterator end) {
+    tokens_.clear();
+    for (; begin != end; ++begin) {
+      tokens_.push_back(*begin);
+    }
+  }
+
+  iterator_type begin() const { return tokens_.cbegin(); }
+  iterator_type end() const { return tokens_.cend(); }
+
+  size_t size() const { return tokens_.size(); }
+  const value_type& operator[](size_t index) const { return tokens_[index]; }
+
+ private:
+  std::vector<value_type> tokens_;
+};
+}  // namespace base
+#endif
@@ -0,0 +1,184 @@
+#ifndef KOLIBRI_SRC_TOKEN_STORE_H_
+#define KOLIBRI_SRC_TOKEN_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <iterator>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "base/token.h"
+
+namespace base {
+// The TokenStore keeps the tokens of a single source buffer in three parallel arrays: a 1 byte
+// id, a 32 bit offset into the source and a 32 bit length. That are 9 bytes per token instead of
+// the 24 bytes of a Token. The tokens are accessed by trivially copyable handles; the value of a
+// token is resolved against the source buffer. The iterator yields Tokens, so a grammar can be
+// instantiated on it like on a TokenBuffer, see e.g. PascalStoreParser.
+template <typename TId, typename TIdConverter>
+class TokenStore {
+ public:
+  using id_type = TId;
+  using token_type = Token<TId, TIdConverter>;
+
+  // A reference to a token of the store.
+  class Handle {
+   public:
+    Handle() : store_(nullptr), index_(0) {}
+    Handle(const TokenStore* store, uint32_t index) : store_(store), index_(index) {}
+
+    id_type GetId() const { return static_cast<id_type>(store_->ids_[index_]); }
+    const char* GetStringId() const { return TIdConverter::ToString(GetId()); }
+    std::string_view GetValue() const { return std::string_view(store_->source_ + store_->offsets_[index_], store_->lengths_[index_]); }
+    uint32_t GetIndex() const { return index_; }
+    uint32_t GetOffset() const { return store_->offsets_[index_]; }
+
+    token_type ToToken() const { return token_type(GetId(), store_->source_ + store_->offsets_[index_], store_->lengths_[index_]); }
+
+    bool operator==(const Handle& rhs) const { return (GetId() == rhs.GetId()) && (GetValue() == rhs.GetValue()); }
+    bool operator!=(const Handle& rhs) const { return !(*this == rhs); }
+
+   private:
+    const TokenStore* store_;
+    uint32_t index_;
+  };
+
+  // The tokens are created when the iterator is dereferenced.
+  class Iterator {
+   public:
+    using value_type = token_type;
+    using difference_type = ptrdiff_t;
+    using pointer = const token_type*;
+    using reference = token_type;
+    using iterator_category = std::random_access_iterator_tag;
+
+    Iterator() : store_(nullptr), index_(0) {}
+    Iterator(const TokenStore* store, uint32_t index) : store_(store), index_(index) {}
+
+    token_type operator*() const { return Handle(store_, index_).ToToken(); }
+    token_type operator[](difference_type n) const { return Handle(store_, static_cast<uint32_t>(index_ + n)).ToToken(); }
+
+    Iterator& operator++() {
+      index_++;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator tmp(*this);
+      index_++;
+      return tmp;
+    }
+    Iterator& operator--() {
+      index_--;
+      return *this;
+    }
+    Iterator operator--(int) {
+      Iterator tmp(*this);
+      index_--;
+      return tmp;
+    }
+    Iterator& operator+=(difference_type n) {
+      index_ = static_cast<uint32_t>(index_ + n);
+      return *this;
+    }
+    Iterator& operator-=(difference_type n) {
+      index_ = static_cast<uint32_t>(index_ - n);
+      return *this;
+    }
+    Iterator operator+(difference_type n) const { return Iterator(store_, static_cast<uint32_t>(index_ + n)); }
+    Iterator operator-(difference_type n) const { return Iterator(store_, static_cast<uint32_t>(index_ - n)); }
+    difference_type operator-(const Iterator& rhs) const { return static_cast<difference_type>(index_) - static_cast<difference_type>(rhs.index_); }
+
+    bool operator==(const Iterator& rhs) const { return (store_ == rhs.store_) && (index_ == rhs.index_); }
+    bool operator!=(const Iterator& rhs) const { return !(*this == rhs); }
+    bool operator<(const Iterator& rhs) const { return index_ < rhs.index_; }
+    bool operator>(const Iterator& rhs) const { return rhs < *this; }
+    bool operator<=(const Iterator& rhs) const { return !(rhs < *this); }
+    bool operator>=(const Iterator& rhs) const { return !(*this < rhs); }
+
+    friend Iterator operator+(difference_type n, const Iterator& it) { return it + n; }
+
+   private:
+    const TokenStore* store_;
+    uint32_t index_;
+  };
+
+  using iterator_type = Iterator;
+
+  // The source buffer must outlive the store. Tokens behind the first 4 GiB of it can't be stored.
+  TokenStore(const char* source, size_t len) : source_(source), len_(len), ids_(), offsets_(), lengths_() {}
+
+  TokenStore(TokenStore const&) = delete;
+  TokenStore& operator=(TokenStore const&) = delete;
+
+  // Appends a token whose value lies inside the source buffer. Returns false and adds nothing when
+  // the value is outside of it, ends behind the first 4 GiB or the id doesn't fit into a byte.
+  bool Add(const token_type& token) {
+    auto value = token.GetValue();
+    if (value.data() == nullptr) {
+      return Add(token.GetId(), source_ + len_, source_ + len_);  // tokens without a value, e.g. end of file
+    }
+    return Add(token.GetId(), value.data(), value.data() + value.size());
+  }
+
+  bool Add(id_type id, const char* begin, const char* end) {
+    if ((begin < source_) || (end < begin) || (end > source_ + len_)) {
+      return false;
+    }
+    if ((static_cast<uint64_t>(end - source_) > std::numeric_limits<uint32_t>::max()) ||
+        (static_cast<uint64_t>(id) > std::numeric_limits<uint8_t>::max())) {
+      return false;
+    }
+    ids_.push_back(static_cast<uint8_t>(id));
+    offsets_.push_back(static_cast<uint32_t>(begin - source_));
+    lengths_.push_back(static_cast<uint32_t>(end - begin));
+    return true;
+  }
+
+  // Stores all tokens of the given range, e.g. lexer.begin() and lexer.end(). Returns false at the
+  // first token which can't be stored, the tokens before it are kept.
+  template <typename TIterator>
+  bool Assign(TIterator begin, TIterator end) {
+    Clear();
+    for (; begin != end; ++begin) {
+      if (!Add(*begin)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void Clear() {
+    ids_.clear();
+    offsets_.clear();
+    lengths_.clear();
+  }
+
+  void Reserve(size_t count) {
+    ids_.reserve(count);
+    offsets_.reserve(count);
+    lengths_.reserve(count);
+  }
+
+  size_t size() const { return ids_.size(); }
+  Handle operator[](size_t index) const { return Handle(this, static_cast<uint32_t>(index)); }
+
+  iterator_type begin() const { return Iterator(this, 0); }
+  iterator_type end() const { return Iterator(this, static_cast<uint32_t>(ids_.size())); }
+
+  // raw access to the parallel arrays
+  const uint8_t* ids() const { return ids_.data(); }
+  const uint32_t* offsets() const { return offsets_.data(); }
+  const uint32_t* lengths() const { return lengths_.data(); }
+
+ private:
+  const char* source_;
+  size_t len_;
+  std::vector<uint8_t> ids_;
+  std::vector<uint32_t> offsets_;
+  std::vector<uint32_t> lengths_;
+};
+}  // namespace base
+#endif
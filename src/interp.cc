@@ -3,6 +3,7 @@
 #include <fstream>
 #include <iostream>
 #include <type_traits>
+#include "base/source_manager.h"
 #include "languages/ast_factory.h"
 #include "languages/ast_types.h"
 #include "languages/print_ast.h"
@@ -44,14 +45,20 @@ void operator delete[](void *p) noexcept{
 }
 #endif
 
-void doPascal(string content) {
-  PascalLexer lexer(content.c_str(), strlen(content.c_str()));
+void doPascal(const SourceBuffer& source) {
+  const char* invalid = utf8::Validate(source.begin(), source.end());
+  if (invalid != source.end()) {
+    cout << source.GetLineIndex().Format(source.GetName(), invalid, "invalid UTF-8") << endl;
+    return;
+  }
+
+  PascalUtf8Lexer lexer(source.begin(), source.size());
   AstFactory<std::shared_ptr<Ast<MakeShared, PascalToken>>, PascalToken> ast_factory;
-  PascalParserFactory parser_factory(ast_factory);
-  PascalParser pparser(parser_factory);
+  PascalStaticParserFactory parser_factory(ast_factory);
+  PascalStoreParser pparser(parser_factory);
 
   cout << is_skip_production_class<SkipProduction>::value<<endl<<flush;
-  // CalcLexer lexer(content.c_str(), strlen(content.c_str()));
+  // CalcLexer lexer(source.begin(), source.size());
   // AstFactory<CalcAstTraits> ast_factory;
   // Parser<CGrammar> pparser(ast_factory);
 
@@ -62,34 +69,43 @@ void doPascal(string content) {
     cout << (*it) << endl;
   }
 
-  auto res = pparser.Expr(lexer.begin(), lexer.end());
+  PascalTokenStore tokens(source.begin(), source.size());
+  if (!tokens.Assign(lexer.begin(), lexer.end())) {
+    cout << "ERROR: Source too large" << endl;
+    return;
+  }
+  auto res = pparser.Expr(tokens.begin(), tokens.end());
   cout << "------------------" << endl;
   cout << "Parsing:" << endl;
   if (res.is_error) {
-    cout << "ERROR" << endl;
+    cout << source.GetLineIndex().Format(source.GetName(), res.error_position, res.error_msg) << endl;
+  } else {
+    cout << res.error_msg << endl;
   }
-  cout << res.error_msg << endl;
   PrintAst<MakeShared, PascalToken> show_ast;
   cout << "Writing Ast to output.dot" << endl;
   ofstream dot_file("output.dot");
-  show_ast.Print(dot_file, res.node);
+  show_ast.Print(dot_file, res.node, &source.GetLineIndex());
 
   cout << "------------------" << endl;
 
   PascalInterpreter<MakeShared, PascalToken> pascal_interp;
-  auto result = pascal_interp.Interpret(res.node);
+  auto result = pascal_interp.Interpret(res.node, ast_factory.GetSymbolTable());
   auto var_list = result.ListVariables();
   cout << var_list << endl;
+  for (const auto& diagnostic : result.GetDiagnostics()) {
+    cout << diagnostic << endl;
+  }
 }
 
 int main(int argc, char* argv[]) {
   if (argc == 2) {
     string filename = argv[1];
-    ifstream myfile(filename);
+    SourceManager source_manager;  // keeps the source alive for all tokens and ast nodes
+    auto source = source_manager.Load(filename);
 
-    if (myfile.is_open()) {
-      std::string str((std::istreambuf_iterator<char>(myfile)), std::istreambuf_iterator<char>());
-      doPascal(str);
+    if (source) {
+      doPascal(*source);
     } else {
       cout << "ERROR: Unable to open file \"" << filename << "\"." << endl;
       return -1;
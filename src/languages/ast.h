@@ -1,10 +1,16 @@
 #ifndef KOLIBRI_SRC_AST_H_
 #define KOLIBRI_SRC_AST_H_
 
+#include <stdint.h>
+
 #include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
+#include "base/numeric_literal.h"
+#include "base/symbol_table.h"
 #include "languages/ast_id.h"
 #include "languages/i_ast_visitor.h"
 
@@ -25,6 +31,17 @@ enum class AstTypeId {
 
 
 
+// The text of a terminal. Terminals are tokens or, e.g. in tests, plain strings. The result may be
+// a temporary string which has to outlive views to it.
+template <typename TTerm>
+auto GetTermText(TTerm& term) {
+  if constexpr (std::is_convertible<TTerm&, std::string_view>::value) {
+    return std::string_view(term);
+  } else {
+    return term.GetValue();
+  }
+}
+
 template <template <class> class TMakeType, typename TTerm>
 class Ast {
  public:
@@ -53,14 +70,18 @@ class AstId : public Ast<TMakeType, TTerm> {
   using nonterm_type = typename Ast<TMakeType, TTerm>::nonterm_type;
   using term_type = typename Ast<TMakeType, TTerm>::term_type;
 
-  explicit AstId(term_type name) { name_ = name; }
+  explicit AstId(term_type name, base::SymbolTable::symbol_type symbol = base::SymbolTable::kNoSymbol) : name_(name), symbol_(symbol) {}
   AstTypeId GetTypeId() override { return AstTypeId::kAstId; }
   VisitorReturn Accept(IAstVisitor<TMakeType, term_type>& visitor) override { return visitor.Visit(*this); }
 
   term_type GetName() { return name_; }
 
+  // Id of the interned name or kNoSymbol
+  base::SymbolTable::symbol_type GetSymbol() const { return symbol_; }
+
  private:
   term_type name_;
+  base::SymbolTable::symbol_type symbol_;
 };
 
 template <template <class> class TMakeType, typename TTerm>
@@ -105,7 +126,11 @@ class AstConst : public Ast<TMakeType, TTerm> {
   using nonterm_type = typename Ast<TMakeType, TTerm>::nonterm_type;
   using term_type = typename Ast<TMakeType, TTerm>::term_type;
 
-  explicit AstConst(ConstType const_type, term_type value) : const_type_(const_type), value_(value) {}
+  // The literal is decoded once here, evaluating the constant only reads the decoded value.
+  explicit AstConst(ConstType const_type, term_type value)
+      : const_type_(const_type), value_(value), integer_(0), real_(0.0), status_(base::LiteralStatus::kOk) {
+    Decode();
+  }
   AstTypeId GetTypeId() override { return AstTypeId::kAstConst; }
 
   VisitorReturn Accept(IAstVisitor<TMakeType, term_type>& visitor) override { return visitor.Visit(*this); }
@@ -114,9 +139,39 @@ class AstConst : public Ast<TMakeType, TTerm> {
 
   term_type GetValue() { return value_; }
 
+  // Decoded value of an integer constant, 0 when the literal couldn't be decoded.
+  int64_t GetInteger() const { return integer_; }
+
+  // Decoded value of a constant as double. Integer constants are converted.
+  double GetReal() const { return real_; }
+
+  // Whether the literal could be decoded. Reported by the interpreters as diagnostic.
+  base::LiteralStatus GetStatus() const { return status_; }
+
  private:
+  void Decode() {
+    auto text = GetTermText(value_);
+    std::string_view view(text);
+    switch (const_type_) {
+      case ConstType::kInteger:
+        status_ = base::ParseInteger(view, integer_);
+        real_ = static_cast<double>(integer_);
+        break;
+      case ConstType::kReal:
+        status_ = base::ParseReal(view, real_);
+        break;
+    }
+    if (status_ != base::LiteralStatus::kOk) {
+      integer_ = 0;
+      real_ = 0.0;
+    }
+  }
+
   ConstType const_type_;
   term_type value_;
+  int64_t integer_;
+  double real_;
+  base::LiteralStatus status_;
 };
 
 template <template <class> class TMakeType, typename TTerm>
@@ -202,18 +257,23 @@ class AstVariableDeclaration : public Ast<TMakeType, TTerm> {
   using nonterm_type = typename Ast<TMakeType, TTerm>::nonterm_type;
   using term_type = typename Ast<TMakeType, TTerm>::term_type;
 
-  explicit AstVariableDeclaration(term_type id, term_type type) : id_(id), type_(type) {}
+  explicit AstVariableDeclaration(term_type id, term_type type, base::SymbolTable::symbol_type symbol = base::SymbolTable::kNoSymbol)
+      : id_(id), type_(type), symbol_(symbol) {}
 
   AstTypeId GetTypeId() override { return AstTypeId::kAstVariableDeclaration; }
 
   term_type GetId() { return id_; }
   term_type GetType() { return type_; }
 
+  // Id of the interned variable name or kNoSymbol
+  base::SymbolTable::symbol_type GetSymbol() const { return symbol_; }
+
   VisitorReturn Accept(IAstVisitor<TMakeType, term_type>& visitor) override { return visitor.Visit(*this); }
 
  private:
   term_type id_;
   term_type type_;
+  base::SymbolTable::symbol_type symbol_;
 };
 
 template <template <class> class TMakeType, typename TTerm>
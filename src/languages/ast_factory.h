@@ -6,17 +6,24 @@
 #include <string>
 #include <vector>
 
+#include "base/symbol_table.h"
 #include "languages/ast.h"
 #include "languages/ast_types.h"
 #include "languages/i_ast_factory.h"
 namespace languages {
 
+// final, so parser factories which hold an AstFactory instead of an IAstFactory call it statically
 template <typename TNonTerm, typename TTerm>
-class AstFactory : public IAstFactory<TNonTerm, TTerm> {
+class AstFactory final : public IAstFactory<TNonTerm, TTerm> {
  public:
   using nonterm_type = TNonTerm;
   using term_type = TTerm;
 
+  AstFactory() : symbols_(std::make_shared<base::SymbolTable>()) {}
+
+  // Identifiers are interned while the AST is created. The interpreter looks variables up by id.
+  std::shared_ptr<const base::SymbolTable> GetSymbolTable() const { return symbols_; }
+
   virtual nonterm_type CreateNull() override { return nullptr; }
 
   virtual nonterm_type CreateNop() override { return std::make_shared<AstNop<MakeShared, TTerm>>(); }
@@ -27,7 +34,7 @@ class AstFactory : public IAstFactory<TNonTerm, TTerm> {
     return std::make_shared<AstBlock<MakeShared, TTerm>>(var_decls, compound_statement);
   }
 
-  virtual nonterm_type CreateId(term_type name) override { return std::make_shared<AstId<MakeShared, TTerm>>(name); }
+  virtual nonterm_type CreateId(term_type name) override { return std::make_shared<AstId<MakeShared, TTerm>>(name, symbols_->Intern(GetTermText(name))); }
 
   virtual nonterm_type CreateRaw(term_type term) override { return std::make_shared<AstRaw<MakeShared, TTerm>>(term); }
 
@@ -44,10 +51,13 @@ class AstFactory : public IAstFactory<TNonTerm, TTerm> {
   }
 
   virtual nonterm_type CreateVariableDeclaration(term_type id, term_type type) override {
-    return std::make_shared<AstVariableDeclaration<MakeShared, TTerm>>(id, type);
+    return std::make_shared<AstVariableDeclaration<MakeShared, TTerm>>(id, type, symbols_->Intern(GetTermText(id)));
   }
 
   virtual nonterm_type CreateRawList(std::vector<TNonTerm> const& var_decls) override { return std::make_shared<AstRawList<MakeShared, TTerm>>(var_decls); }
+
+ private:
+  std::shared_ptr<base::SymbolTable> symbols_;
 };
 }  // namespace languages
 #endif
\ No newline at end of file
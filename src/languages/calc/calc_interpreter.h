@@ -1,8 +1,11 @@
 #ifndef KOLIBRI_SRC_CALC_INTERPRETER_H_
 #define KOLIBRI_SRC_CALC_INTERPRETER_H_
 
+#include <limits.h>
+
 #include <string>
 
+#include "base/numeric_literal.h"
 #include "languages/ast.h"
 #include "languages/i_ast_visitor.h"
 
@@ -17,9 +20,19 @@ class CalcInterpreter {
 
   class Visitor : public IAstVisitor<TMakeType, term_type> {
    public:
+    Visitor() : status_(base::LiteralStatus::kOk) {}
+
     VisitorReturn Visit(AstConst<TMakeType, term_type>& ast) override {
-      int return_int = std::stoi(std::string(ast.GetValue().GetValue()));
-      return VisitorReturn(return_int);
+      auto status = ast.GetStatus();
+      auto value = ast.GetInteger();
+      if ((status == base::LiteralStatus::kOk) && ((value < INT_MIN) || (value > INT_MAX))) {
+        status = base::LiteralStatus::kOutOfRange;  // calc computes with int
+        value = 0;
+      }
+      if (status_ == base::LiteralStatus::kOk) {
+        status_ = status;
+      }
+      return VisitorReturn(static_cast<int>(value));
     }
     VisitorReturn Visit(AstProgram<TMakeType, term_type>& ast) override { return VisitorReturn(); }
     VisitorReturn Visit(AstBlock<TMakeType, term_type>& ast) override { return VisitorReturn(); }
@@ -66,12 +79,22 @@ class CalcInterpreter {
       }
       return VisitorReturn(return_int);
     }
+
+    // The status of the first literal which couldn't be decoded or kOk.
+    base::LiteralStatus GetStatus() const { return status_; }
+
+   private:
+    base::LiteralStatus status_;
   };
 
+  // Returns the result or a diagnostic when a literal couldn't be decoded.
   std::string Interpret(nonterm_type node) {
     Visitor visitor;
 
     auto res = node->Accept(visitor);
+    if (visitor.GetStatus() != base::LiteralStatus::kOk) {
+      return std::string("ERROR: ") + base::ToString(visitor.GetStatus());
+    }
     std::string expr = std::to_string(res.GetIntRepresentation());
 
     return expr;
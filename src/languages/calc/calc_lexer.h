@@ -3,8 +3,12 @@
 
 #include "languages/calc/calc_token.h"
 #include "lexer/lexer.h"
+#include "lexer/lexer_dfa_rules.h"
+#include "lexer/lexer_incremental.h"
+#include "lexer/lexer_parallel.h"
 #include "lexer/lexer_predicates.h"
 #include "lexer/lexer_rules.h"
+#include "lexer/lexer_stream.h"
 #include "string_providers.h"
 
 namespace languages {
@@ -14,13 +18,14 @@ template <CalcTokenId Id>
 class CalcLexerProduction {
  public:
   using value_type = CalcToken;
-  value_type Create(const char* begin, const char* end) { return CalcToken(Id, begin, end); }
+  constexpr value_type Create(const char* begin, const char* end) { return CalcToken(Id, begin, end); }
 };
 
 // clang-format off
 struct CalcLexerRules : public lexer::LexerRulesBase {
-  using type = lexer::LexerRules<       
-      CalcLexerProduction<CalcTokenId::kUnknown>,                 
+  template <template <typename...> class TLexerRules, typename TProductionUNK = CalcLexerProduction<CalcTokenId::kUnknown>>
+  using rules = TLexerRules<       
+      TProductionUNK,
       CalcLexerProduction<CalcTokenId::kEndOfFile>, 
              
       // Skip rules
@@ -34,11 +39,23 @@ struct CalcLexerRules : public lexer::LexerRulesBase {
       Rule<CalcLexerProduction<CalcTokenId::kMinus>, MatcherPredicate<lexer::IsChar<'-'>>>, 
       Rule<CalcLexerProduction<CalcTokenId::kMultiply>, MatcherPredicate<lexer::IsChar<'*'>>>,
       Rule<CalcLexerProduction<CalcTokenId::kDiv>, MatcherPredicate<lexer::IsChar<'/'>>>,
-      Rule<CalcLexerProduction<CalcTokenId::kInteger>, MatcherRangeByPredicate<lexer::IsDigit>>
+      Rule<CalcLexerProduction<CalcTokenId::kInteger>, MatcherSimdRangeByPredicate<lexer::IsDigit>>
   >;
+
+  using type = rules<lexer::LexerRules>;
+  using dfa_type = rules<lexer::DfaLexerRules>;
+
+  // Merges garbage into single unknown tokens and stops after ErrorBudget of them (0: unlimited)
+  template <size_t ErrorBudget>
+  using recovering_type = rules<lexer::DfaLexerRules, lexer::CoalesceUnknown<CalcLexerProduction<CalcTokenId::kUnknown>, ErrorBudget>>;
 };
 
 using CalcLexer = lexer::Lexer<CalcLexerRules::type>;
+using CalcDfaLexer = lexer::Lexer<CalcLexerRules::dfa_type>;
+using CalcRecoveringLexer = lexer::Lexer<CalcLexerRules::recovering_type<0>>;
+using CalcStreamLexer = lexer::StreamLexer<CalcLexerRules::dfa_type>;
+using CalcParallelLexer = lexer::ParallelLexer<CalcLexerRules::dfa_type>;
+using CalcIncrementalLexer = lexer::IncrementalLexer<CalcLexerRules::dfa_type>;
 
 // clang-format on  
 
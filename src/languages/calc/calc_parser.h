@@ -2,12 +2,15 @@
 #define KOLIBRI_SRC_CALC_PARSER_H_
 
 #include "base/token.h"
+#include "base/token_buffer.h"
 #include "languages/ast.h"
 #include "languages/ast_types.h"
 #include "languages/calc/calc_lexer.h"
+#include "languages/calc/calc_parser_factory.h"
 #include "languages/calc/calc_token.h"
 #include "parser/i_parser_factory.h"
 #include "parser/parser.h"
+#include "parser/parser_ll1_grammar.h"
 #include "parser/parser_productions.h"
 #include "parser/parser_rules.h"
 
@@ -17,45 +20,38 @@ namespace calc {
 template <CalcTokenId Id>
 class CalcTokenPredicate {
  public:
+  static constexpr CalcTokenId kId = Id;  // used for the FIRST sets of the grammar
+
   bool operator()(CalcToken token) { return token.GetId() == Id; };
 };
 
-template <typename TNonTerm, typename Iterator>
+// TParserGrammar is parser::ParserGrammar, parser::PackratParserGrammar or parser::LL1ParserGrammar
+template <typename TNonTerm, typename Iterator, template <typename...> class TParserGrammar = parser::ParserGrammar>
 struct CalculatorGrammar : public parser::GrammarBase {
   // clang-format off
-  using type = parser::ParserGrammar<
+  using type = TParserGrammar<
     TNonTerm, Iterator,
 
     // Rule #0
-    Rule<parser::NonTermTermNonTermSequenceProduction,
-      SequenceExpr<
-        NonTermExpr<parser::RuleId::kRule1>,
-        NMatchesOrMoreExpr<0,
-          SequenceExpr<
-            OrderedChoiceExpr<
-              TermExpr<CalcTokenPredicate<CalcTokenId::kPlus>>, 
-              TermExpr<CalcTokenPredicate<CalcTokenId::kMinus>>
-            >, 
-            NonTermExpr<parser::RuleId::kRule1>
-          >
-        >
+    // expr : factor ((PLUS | MINUS | MUL | DIV) factor)*
+    // where MUL and DIV bind stronger, their nodes are created with rule #1
+    Rule<parser::BypassLastTermProduction,
+      PrecedenceExpr<
+        NonTermExpr<parser::RuleId::kRule2>,
+        BinaryOperator<parser::RuleId::kRule0, CalcTokenPredicate<CalcTokenId::kPlus>, 1>,
+        BinaryOperator<parser::RuleId::kRule0, CalcTokenPredicate<CalcTokenId::kMinus>, 1>,
+        BinaryOperator<parser::RuleId::kRule1, CalcTokenPredicate<CalcTokenId::kMultiply>, 2>,
+        BinaryOperator<parser::RuleId::kRule1, CalcTokenPredicate<CalcTokenId::kDiv>, 2>
       >
     >,
-    
 
     // Rule #1
-    Rule<parser::NonTermTermNonTermSequenceProduction, 
-      SequenceExpr<
+    // term : factor ((MUL | DIV) factor)*
+    Rule<parser::BypassLastTermProduction,
+      PrecedenceExpr<
         NonTermExpr<parser::RuleId::kRule2>,
-        NMatchesOrMoreExpr<0,
-          SequenceExpr<
-            OrderedChoiceExpr<
-              TermExpr<CalcTokenPredicate<CalcTokenId::kMultiply>>,
-              TermExpr<CalcTokenPredicate<CalcTokenId::kDiv>>
-            >, 
-            NonTermExpr<parser::RuleId::kRule2>
-          >
-        >
+        BinaryOperator<parser::RuleId::kRule1, CalcTokenPredicate<CalcTokenId::kMultiply>, 2>,
+        BinaryOperator<parser::RuleId::kRule1, CalcTokenPredicate<CalcTokenId::kDiv>, 2>
       >
     >,
 
@@ -88,8 +84,13 @@ struct CalculatorGrammar : public parser::GrammarBase {
   // clang-format on
 };
 
-using CalcGrammar = CalculatorGrammar<std::shared_ptr<Ast<MakeShared, CalcToken>>, CalcLexer::iterator_type>::type;
+using CalcGrammar = CalculatorGrammar<std::shared_ptr<Ast<MakeShared, CalcToken>>, base::TokenBuffer<CalcToken>::iterator_type>::type;
 using CalcParser = parser::Parser<CalcGrammar>;
+using CalcStaticParser = parser::Parser<CalcGrammar, CalcStaticParserFactory>;  // no virtual calls to the factories
+using CalcPackratGrammar = CalculatorGrammar<std::shared_ptr<Ast<MakeShared, CalcToken>>, base::TokenBuffer<CalcToken>::iterator_type, parser::PackratParserGrammar>::type;
+using CalcPackratParser = parser::Parser<CalcPackratGrammar>;
+using CalcLL1Grammar = CalculatorGrammar<std::shared_ptr<Ast<MakeShared, CalcToken>>, base::TokenBuffer<CalcToken>::iterator_type, parser::LL1ParserGrammar>::type;
+using CalcLL1Parser = parser::Parser<CalcLL1Grammar>;
 
 }  // namespace calc
 }  // namespace languages
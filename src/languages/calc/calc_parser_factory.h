@@ -2,6 +2,7 @@
 #define KOLIBRI_SRC_CALC_PARSER_FACTORY_H_
 
 #include "languages/ast.h"
+#include "languages/ast_factory.h"
 #include "languages/ast_types.h"
 #include "languages/i_ast_factory.h"
 #include "languages/calc/calc_token.h"
@@ -10,17 +11,22 @@
 namespace languages {
 namespace calc {
 
-class CalcParserFactory : public parser::IParserFactory<std::shared_ptr<Ast<MakeShared, CalcToken>>, CalcToken> {
+// Creates the AST through TAstFactory. With AstFactory instead of the IAstFactory interface, and
+// called statically by the parser, no call is virtual and the switches on the rule id fold away.
+template <typename TAstFactory>
+class BasicCalcParserFactory final : public parser::StaticParserFactory<BasicCalcParserFactory<TAstFactory>, std::shared_ptr<Ast<MakeShared, CalcToken>>, CalcToken> {
  public:
   using nonterm_type = std::shared_ptr<Ast<MakeShared, CalcToken>>;
   using term_type = CalcToken;
 
-  CalcParserFactory(IAstFactory<nonterm_type, term_type>& ast_factory) : ast_factory_(ast_factory) {}
+  BasicCalcParserFactory(TAstFactory& ast_factory) : ast_factory_(ast_factory) {}
 
   nonterm_type CreateNull() override { return ast_factory_.CreateNull(); }
-  nonterm_type CreateEmpty(parser::RuleId rule_id) override { return ast_factory_.CreateNop(); }
+  template <typename TRuleId>
+  nonterm_type CreateEmpty(TRuleId rule_id) { return ast_factory_.CreateNop(); }
 
-  nonterm_type CreateTerm(parser::RuleId rule_id, term_type term) override {
+  template <typename TRuleId>
+  nonterm_type CreateTerm(TRuleId rule_id, term_type term) {
     switch (rule_id) {
       case parser::RuleId::kRule2: {
         return ast_factory_.CreateConst(ConstType::kInteger, term);
@@ -33,9 +39,11 @@ class CalcParserFactory : public parser::IParserFactory<std::shared_ptr<Ast<Make
     }
   }
 
-  nonterm_type CreateNonTerm(parser::RuleId rule_id, nonterm_type nonterm) override { return ast_factory_.CreateNull(); }
+  template <typename TRuleId>
+  nonterm_type CreateNonTerm(TRuleId rule_id, nonterm_type nonterm) { return ast_factory_.CreateNull(); }
 
-  nonterm_type CreateTermNonTerm(parser::RuleId rule_id, term_type term, nonterm_type nonterm) override {
+  template <typename TRuleId>
+  nonterm_type CreateTermNonTerm(TRuleId rule_id, term_type term, nonterm_type nonterm) {
     switch (rule_id) {
       case parser::RuleId::kRule2: {
         return ast_factory_.CreateUnaryOp(term, nonterm);
@@ -48,9 +56,11 @@ class CalcParserFactory : public parser::IParserFactory<std::shared_ptr<Ast<Make
     return ast_factory_.CreateNull();
   }
 
-  nonterm_type CreateNonTermNonTerm(parser::RuleId rule_id, nonterm_type lhs, nonterm_type rhs) override { return rhs; }
+  template <typename TRuleId>
+  nonterm_type CreateNonTermNonTerm(TRuleId rule_id, nonterm_type lhs, nonterm_type rhs) { return rhs; }
 
-  nonterm_type CreateNonTermTermNonTerm(parser::RuleId rule_id, nonterm_type lhs, term_type term, nonterm_type rhs) override {
+  template <typename TRuleId>
+  nonterm_type CreateNonTermTermNonTerm(TRuleId rule_id, nonterm_type lhs, term_type term, nonterm_type rhs) {
     switch (rule_id) {
       case parser::RuleId::kRule0: {
         return ast_factory_.CreateBinaryOp(lhs, term, rhs);
@@ -66,18 +76,23 @@ class CalcParserFactory : public parser::IParserFactory<std::shared_ptr<Ast<Make
     return ast_factory_.CreateNull();
   }
 
-  nonterm_type CreateNonTermList(parser::RuleId rule_id, std::vector<nonterm_type> statements) override {
+  template <typename TRuleId>
+  nonterm_type CreateNonTermList(TRuleId rule_id, std::vector<nonterm_type> statements) {
     return ast_factory_.CreateCompoundStatement(statements);
   }
 
-  nonterm_type CreateTermNonTermList(parser::RuleId rule_id, std::vector<term_type> terms, std::vector<nonterm_type> nonterms) override {
+  template <typename TRuleId>
+  nonterm_type CreateTermNonTermList(TRuleId rule_id, std::vector<term_type> terms, std::vector<nonterm_type> nonterms) {
     return ast_factory_.CreateNull();
   }
 
  private:
-  IAstFactory<nonterm_type, term_type>& ast_factory_;
+  TAstFactory& ast_factory_;
 };
 
+using CalcParserFactory = BasicCalcParserFactory<IAstFactory<std::shared_ptr<Ast<MakeShared, CalcToken>>, CalcToken>>;
+using CalcStaticParserFactory = BasicCalcParserFactory<AstFactory<std::shared_ptr<Ast<MakeShared, CalcToken>>, CalcToken>>;
+
 }  // namespace calc
 }  // namespace languages
 #endif
\ No newline at end of file
@@ -1,35 +1,100 @@
 #ifndef KOLIBRI_SRC_PASCAL_INTERPRETER_H_
 #define KOLIBRI_SRC_PASCAL_INTERPRETER_H_
 
-#include <map>
+#include <assert.h>
+
+#include <algorithm>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "base/symbol_table.h"
 #include "languages/ast.h"
 #include "languages/i_ast_visitor.h"
 
 namespace languages {
 namespace pascal {
 
+// The variables of a program, indexed by the symbol ids of their names. Names which aren't in the
+// symbol table of the AST get ids after the ones of the table.
 class PascalState {
  public:
-  PascalState() : global_scope_() {}
+  using symbol_type = base::SymbolTable::symbol_type;
 
-  void Assign(std::string var_name, double value) { global_scope_[var_name] = value; }
+  PascalState() : PascalState(std::make_shared<const base::SymbolTable>()) {}
 
-  double Get(std::string var_name) { return global_scope_[var_name]; }
+  explicit PascalState(std::shared_ptr<const base::SymbolTable> symbols)
+      : symbols_(std::move(symbols)),
+        num_symbols_(static_cast<symbol_type>(symbols_->size())),
+        local_symbols_(std::make_shared<base::SymbolTable>()),
+        values_(num_symbols_, 0.0),
+        used_(num_symbols_, false),
+        diagnostics_() {}
 
+  // The symbol of a name of a node which wasn't interned by the AST factory.
+  symbol_type Intern(std::string_view name) {
+    symbol_type symbol = symbols_->Find(name);
+    if ((symbol != base::SymbolTable::kNoSymbol) && (symbol < num_symbols_)) {
+      return symbol;
+    }
+    return num_symbols_ + local_symbols_->Intern(name);
+  }
+
+  void Assign(symbol_type symbol, double value) {
+    Reserve(symbol);
+    values_[symbol] = value;
+    used_[symbol] = true;
+  }
+
+  double Get(symbol_type symbol) {
+    Reserve(symbol);
+    used_[symbol] = true;
+    return values_[symbol];
+  }
+
+  // All used variables sorted by name
   std::string ListVariables() {
+    std::vector<symbol_type> used;
+    for (symbol_type symbol = 0; symbol < used_.size(); ++symbol) {
+      if (used_[symbol]) {
+        used.push_back(symbol);
+      }
+    }
+    std::sort(used.begin(), used.end(), [this](symbol_type lhs, symbol_type rhs) { return GetName(lhs) < GetName(rhs); });
+
     std::stringstream ss;
-    for (auto it = global_scope_.begin(); it != global_scope_.end(); ++it) {
-      auto entry = *it;
-      ss << entry.first << " := " << entry.second << std::endl;
+    for (auto symbol : used) {
+      ss << GetName(symbol) << " := " << values_[symbol] << std::endl;
     }
     return ss.str();
   }
 
+  void AddDiagnostic(std::string message) { diagnostics_.push_back(std::move(message)); }
+
+  const std::vector<std::string>& GetDiagnostics() const { return diagnostics_; }
+
  private:
-  std::map<std::string, double> global_scope_;
+  // all symbols are known before the program runs, only symbols interned later need more room
+  void Reserve(symbol_type symbol) {
+    assert(symbol != base::SymbolTable::kNoSymbol);
+    if (symbol >= values_.size()) {
+      values_.resize(symbol + 1, 0.0);
+      used_.resize(symbol + 1, false);
+    }
+  }
+
+  const std::string& GetName(symbol_type symbol) const {
+    return symbol < num_symbols_ ? symbols_->GetName(symbol) : local_symbols_->GetName(symbol - num_symbols_);
+  }
+
+  std::shared_ptr<const base::SymbolTable> symbols_;
+  symbol_type num_symbols_;                       // of symbols_ when the program started
+  std::shared_ptr<base::SymbolTable> local_symbols_;  // names of nodes without symbol
+  std::vector<double> values_;
+  std::vector<bool> used_;
+  std::vector<std::string> diagnostics_;
 };
 
 template <template <class> class TMakeType, typename TTerm>
@@ -46,7 +111,8 @@ class PascalInterpreter {
 
   class Visitor : public IAstVisitor<TMakeType, term_type> {
    public:
-    Visitor(PascalState& state) : state_(state) {}
+    // Without use_symbols the symbols of the nodes are ignored and all names are looked up.
+    Visitor(PascalState& state, bool use_symbols = true) : state_(state), use_symbols_(use_symbols) {}
 
     VisitorReturn Visit(AstProgram<TMakeType, term_type>& ast) override {
       ast.GetProgram()->Accept(*this);
@@ -61,33 +127,16 @@ class PascalInterpreter {
     VisitorReturn Visit(AstVariableDeclaration<TMakeType, term_type>& ast) override { return VisitorReturn(); }
 
     VisitorReturn Visit(AstConst<TMakeType, term_type>& ast) override {
-      auto const_type = ast.GetConstType();
-      auto value = ast.GetValue();
-      double return_double_ = 0.0f;
-      switch (const_type) {
-        case ConstType::kInteger: {
-          auto value_i = std::stoi(std::string(value.GetValue()));
-          return_double_ = static_cast<double>(value_i);
-          break;
-        }
-        case ConstType::kReal: {
-          auto value_d = std::stod(std::string(value.GetValue()));
-          return_double_ = value_d;
-          break;
-        }
-        default: {
-          break;
-        }
+      if (ast.GetStatus() != base::LiteralStatus::kOk) {
+        state_.AddDiagnostic(std::string("ERROR: ") + base::ToString(ast.GetStatus()) + " \"" + std::string(ast.GetValue().GetValue()) + "\"");
       }
-      return VisitorReturn(return_double_);
+      return VisitorReturn(ast.GetReal());  // integer constants are decoded as double too
     }
 
     VisitorReturn Visit(AstNop<TMakeType, term_type>& ast) override { return VisitorReturn(); }
 
     VisitorReturn Visit(AstId<TMakeType, term_type>& ast) override {
-      std::string var_name = std::string(ast.GetName().GetValue());
-      std::for_each(var_name.begin(), var_name.end(), [](char& c) { c = ::tolower(c); });
-      auto return_double_ = state_.Get(std::string(var_name));
+      auto return_double_ = state_.Get(Symbol(ast));
       return VisitorReturn(return_double_);
     }
 
@@ -158,14 +207,11 @@ class PascalInterpreter {
         }
         case term_type::id_type::kAssign: {
           assert(operand_lhs->GetTypeId() == AstTypeId::kAstId);
-          auto& id = dynamic_cast<AstId<MakeShared, term_type>&>(*operand_lhs);
-
-          std::string var_name = std::string(id.GetName().GetValue());
-          std::for_each(var_name.begin(), var_name.end(), [](char& c) { c = ::tolower(c); });
+          auto& id = dynamic_cast<AstId<TMakeType, term_type>&>(*operand_lhs);
 
           auto rhs = operand_rhs->Accept(*this);
 
-          state_.Assign(var_name, rhs.GetDoubleRepresentation());
+          state_.Assign(Symbol(id), rhs.GetDoubleRepresentation());
           return VisitorReturn();
         }
         default:
@@ -174,11 +220,33 @@ class PascalInterpreter {
       return VisitorReturn();
     }
    private:
+    template <typename TAstId>
+    base::SymbolTable::symbol_type Symbol(TAstId& ast) {
+      auto symbol = ast.GetSymbol();
+      if (!use_symbols_ || (symbol == base::SymbolTable::kNoSymbol)) {
+        auto name = ast.GetName();
+        return state_.Intern(GetTermText(name));
+      }
+      return symbol;
+    }
+
     PascalState& state_;
+    bool use_symbols_;
   };
 
+  // Looks all variables up by name, the symbols of the nodes aren't used.
   PascalState Interpret(nonterm_type node) {
     PascalState state;
+    Visitor visitor(state, false);
+    node->Accept(visitor);
+
+    return state;
+  }
+
+  // symbols is the table the identifiers of the AST were interned in, see AstFactory. Nodes without
+  // symbol are looked up by name.
+  PascalState Interpret(nonterm_type node, std::shared_ptr<const base::SymbolTable> symbols) {
+    PascalState state(std::move(symbols));
     Visitor visitor(state);
     node->Accept(visitor);
 
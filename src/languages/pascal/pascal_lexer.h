@@ -3,8 +3,13 @@
 
 #include "languages/pascal/pascal_token.h"
 #include "lexer/lexer.h"
+#include "lexer/lexer_dfa_rules.h"
+#include "lexer/lexer_incremental.h"
+#include "lexer/lexer_keywords.h"
+#include "lexer/lexer_parallel.h"
 #include "lexer/lexer_predicates.h"
 #include "lexer/lexer_rules.h"
+#include "lexer/lexer_stream.h"
 #include "string_providers.h"
 
 namespace languages {
@@ -14,14 +19,35 @@ template <PascalTokenId id>
 class PascalLexerProduction {
  public:
   using value_type = PascalToken;
-  value_type Create(const char* begin, const char* end) { return PascalToken(id, begin, end); }
+  constexpr value_type Create(const char* begin, const char* end) { return PascalToken(id, begin, end); }
+};
+
+using PascalKeywords = lexer::KeywordTable<true,
+                                           lexer::Keyword<PascalTokenId::kIntegerDiv, StringProviderDiv>,
+                                           lexer::Keyword<PascalTokenId::kProgram, StringProviderProgram>,
+                                           lexer::Keyword<PascalTokenId::kInteger, StringProviderInteger>,
+                                           lexer::Keyword<PascalTokenId::kReal, StringProviderReal>,
+                                           lexer::Keyword<PascalTokenId::kVar, StringProviderVar>,
+                                           lexer::Keyword<PascalTokenId::kBegin, StringProviderBegin>,
+                                           lexer::Keyword<PascalTokenId::kEnd, StringProviderEnd>>;
+
+// Creates a keyword token when the identifier is a keyword and a kId token otherwise.
+class PascalIdLexerProduction {
+ public:
+  using value_type = PascalToken;
+  constexpr value_type Create(const char* begin, const char* end) { return PascalToken(PascalKeywords::Find(begin, end, PascalTokenId::kId), begin, end); }
 };
 
 // clang-format off
 struct PascalLexerRules : public lexer::LexerRulesBase {
 
-  using type = lexer::LexerRules< 
-      PascalLexerProduction<PascalTokenId::kUnknown>,                                                         
+  using IdStart = lexer::PredicateOr<lexer::IsLetter, lexer::IsChar<'_'>>;
+
+  template <template <typename...> class TLexerRules,
+            typename TProductionUNK = PascalLexerProduction<PascalTokenId::kUnknown>,
+            typename TIdMatcher = MatcherIdentifier<IdStart, lexer::IsLetterOrDigit>>
+  using rules = TLexerRules< 
+      TProductionUNK,
       PascalLexerProduction<PascalTokenId::kEndOfFile>, 
 
       // Skip rules
@@ -51,45 +77,36 @@ struct PascalLexerRules : public lexer::LexerRulesBase {
       >,
       Rule<PascalLexerProduction<PascalTokenId::kColon>, MatcherPredicate<lexer::IsChar<':'>>>,
       Rule<PascalLexerProduction<PascalTokenId::kComma>, MatcherPredicate<lexer::IsChar<','>>>,
-      Rule<PascalLexerProduction<PascalTokenId::kIntegerDiv>, MatcherString<StringProviderDiv, true>>,  
-      Rule<PascalLexerProduction<PascalTokenId::kProgram>, MatcherString<StringProviderProgram, true>>,
-      Rule<PascalLexerProduction<PascalTokenId::kInteger>, MatcherString<StringProviderInteger, true>>,
-      Rule<PascalLexerProduction<PascalTokenId::kReal>, MatcherString<StringProviderReal, true>>,
-      Rule<PascalLexerProduction<PascalTokenId::kVar>, MatcherString<StringProviderVar, true>>, 
-      Rule<PascalLexerProduction<PascalTokenId::kBegin>, MatcherString<StringProviderBegin, true>>,    
-      Rule<PascalLexerProduction<PascalTokenId::kEnd>, MatcherString<StringProviderEnd, true>>,
       Rule<PascalLexerProduction<PascalTokenId::kRealConst>,
         MatcherSequence< 
-          MatcherRangeByPredicate<lexer::IsDigit>, 
+          MatcherSimdRangeByPredicate<lexer::IsDigit>, 
           MatcherPredicate<lexer::IsChar<'.'>>, 
-          MatcherRangeByPredicate<lexer::IsDigit>
+          MatcherSimdRangeByPredicate<lexer::IsDigit>
         >
       >,                 
-      Rule<PascalLexerProduction<PascalTokenId::kIntegerConst>, MatcherRangeByPredicate<lexer::IsDigit>>, 
-      Rule<PascalLexerProduction<PascalTokenId::kId>,
-      MatcherSequence<  
-          MatcherPredicate<
-            lexer::PredicateOr<
-              lexer::IsLetter, 
-              lexer::IsChar<'_'>
-            >
-          >, 
-          MatcherRangeByPredicate<lexer::IsLetterOrDigit>
-        >
-      >,
-      Rule<PascalLexerProduction<PascalTokenId::kId>, 
-        MatcherPredicate<
-          lexer::PredicateOr<
-            lexer::IsLetter, 
-            lexer::IsChar<'_'>
-          >
-        >
-      >
+      Rule<PascalLexerProduction<PascalTokenId::kIntegerConst>, MatcherSimdRangeByPredicate<lexer::IsDigit>>, 
+      Rule<PascalIdLexerProduction, TIdMatcher>
   >;
+
+  using type = rules<lexer::LexerRules>;
+  using dfa_type = rules<lexer::DfaLexerRules>;
+
+  // Identifiers may contain non ASCII letters. The input has to be validated with lexer::utf8::Validate.
+  using utf8_type = rules<lexer::LexerRules, PascalLexerProduction<PascalTokenId::kUnknown>, MatcherUtf8Identifier<IdStart, lexer::IsLetterOrDigit>>;
+
+  // Merges garbage into single unknown tokens and stops after ErrorBudget of them (0: unlimited)
+  template <size_t ErrorBudget>
+  using recovering_type = rules<lexer::DfaLexerRules, lexer::CoalesceUnknown<PascalLexerProduction<PascalTokenId::kUnknown>, ErrorBudget>>;
 };
 
 // clang-format on
 using PascalLexer = lexer::Lexer<PascalLexerRules::type>;
+using PascalDfaLexer = lexer::Lexer<PascalLexerRules::dfa_type>;
+using PascalUtf8Lexer = lexer::Lexer<PascalLexerRules::utf8_type>;
+using PascalRecoveringLexer = lexer::Lexer<PascalLexerRules::recovering_type<0>>;
+using PascalStreamLexer = lexer::StreamLexer<PascalLexerRules::dfa_type>;
+using PascalParallelLexer = lexer::ParallelLexer<PascalLexerRules::dfa_type>;
+using PascalIncrementalLexer = lexer::IncrementalLexer<PascalLexerRules::dfa_type>;
 
 }  // namespace pascal
 }  // namespace languages
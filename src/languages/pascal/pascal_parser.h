@@ -1,12 +1,16 @@
 #ifndef KOLIBRI_SRC_PASCAL_PARSER_H_
 #define KOLIBRI_SRC_PASCAL_PARSER_H_
 
+#include "base/token_buffer.h"
+#include "base/token_store.h"
 #include "languages/ast_factory.h"
 #include "languages/ast_types.h"
 #include "languages/pascal/pascal_lexer.h"
+#include "languages/pascal/pascal_parser_factory.h"
 #include "languages/pascal/pascal_token.h"
 #include "parser/i_parser_factory.h"
 #include "parser/parser.h"
+#include "parser/parser_ll1_grammar.h"
 #include "parser/parser_productions.h"
 #include "parser/parser_rules.h"
 
@@ -16,14 +20,17 @@ namespace pascal {
 template <PascalTokenId Id>
 class PascalTokenPredicate {
  public:
+  static constexpr PascalTokenId kId = Id;  // used for the FIRST sets of the grammar
+
   bool operator()(PascalToken token) { return token.GetId() == Id; };
 };
 
-template <typename TNonTerm, typename Iterator>
+// TParserGrammar is parser::ParserGrammar, parser::PackratParserGrammar or parser::LL1ParserGrammar
+template <typename TNonTerm, typename Iterator, template <typename...> class TParserGrammar = parser::ParserGrammar>
 struct PascalGrammar : public parser::GrammarBase {
   // clang-format off
  
-  using type = parser::ParserGrammar<
+  using type = TParserGrammar<
     TNonTerm, Iterator,
  
     // Rule #0 - program
@@ -144,36 +151,26 @@ struct PascalGrammar : public parser::GrammarBase {
 
     // Rule #10 - expr
     // expr : term ((PLUS | MINUS) term)*
-    Rule<parser::NonTermTermNonTermSequenceProduction,
-      SequenceExpr<
-        NonTermExpr<parser::RuleId::kRule11>,
-        NMatchesOrMoreExpr<0,
-          SequenceExpr<
-            OrderedChoiceExpr<
-              TermExpr<PascalTokenPredicate<PascalTokenId::kPlus>>, 
-              TermExpr<PascalTokenPredicate<PascalTokenId::kMinus>>
-            >, 
-            NonTermExpr<parser::RuleId::kRule11>
-          >
-        >
+    // term is inlined by operator precedence, the nodes of MUL and DIV are created with rule #11
+    Rule<parser::BypassLastTermProduction,
+      PrecedenceExpr<
+        NonTermExpr<parser::RuleId::kRule12>,
+        BinaryOperator<parser::RuleId::kRule10, PascalTokenPredicate<PascalTokenId::kPlus>, 1>,
+        BinaryOperator<parser::RuleId::kRule10, PascalTokenPredicate<PascalTokenId::kMinus>, 1>,
+        BinaryOperator<parser::RuleId::kRule11, PascalTokenPredicate<PascalTokenId::kMultiply>, 2>,
+        BinaryOperator<parser::RuleId::kRule11, PascalTokenPredicate<PascalTokenId::kIntegerDiv>, 2>,
+        BinaryOperator<parser::RuleId::kRule11, PascalTokenPredicate<PascalTokenId::kFloatDiv>, 2>
       >
     >,
 
     // Rule #11 - term
     // term : factor ((MUL | INTEGER_DIV | FLOAT_DIV) factor)*
-    Rule<parser::NonTermTermNonTermSequenceProduction,
-      SequenceExpr<
+    Rule<parser::BypassLastTermProduction,
+      PrecedenceExpr<
         NonTermExpr<parser::RuleId::kRule12>,
-        NMatchesOrMoreExpr<0,
-          SequenceExpr<
-            OrderedChoiceExpr<
-              TermExpr<PascalTokenPredicate<PascalTokenId::kMultiply>>, 
-              TermExpr<PascalTokenPredicate<PascalTokenId::kIntegerDiv>>,
-              TermExpr<PascalTokenPredicate<PascalTokenId::kFloatDiv>>
-            >, 
-            NonTermExpr<parser::RuleId::kRule12>
-          >
-        >
+        BinaryOperator<parser::RuleId::kRule11, PascalTokenPredicate<PascalTokenId::kMultiply>, 2>,
+        BinaryOperator<parser::RuleId::kRule11, PascalTokenPredicate<PascalTokenId::kIntegerDiv>, 2>,
+        BinaryOperator<parser::RuleId::kRule11, PascalTokenPredicate<PascalTokenId::kFloatDiv>, 2>
       >
     >,
 
@@ -212,8 +209,16 @@ struct PascalGrammar : public parser::GrammarBase {
 
   // clang-format on
 };
-using PascGrammar = PascalGrammar<std::shared_ptr<Ast<MakeShared, PascalToken>>, PascalLexer::iterator_type>::type;
+using PascGrammar = PascalGrammar<std::shared_ptr<Ast<MakeShared, PascalToken>>, base::TokenBuffer<PascalToken>::iterator_type>::type;
 using PascalParser = parser::Parser<PascGrammar>;
+using PascalStaticParser = parser::Parser<PascGrammar, PascalStaticParserFactory>;  // no virtual calls to the factories
+using PascalTokenStore = base::TokenStore<PascalTokenId, PascalTokenIdConverter>;
+using PascStoreGrammar = PascalGrammar<std::shared_ptr<Ast<MakeShared, PascalToken>>, PascalTokenStore::iterator_type>::type;
+using PascalStoreParser = parser::Parser<PascStoreGrammar, PascalStaticParserFactory>;  // parses the tokens of a PascalTokenStore
+using PascPackratGrammar = PascalGrammar<std::shared_ptr<Ast<MakeShared, PascalToken>>, base::TokenBuffer<PascalToken>::iterator_type, parser::PackratParserGrammar>::type;
+using PascalPackratParser = parser::Parser<PascPackratGrammar>;
+using PascLL1Grammar = PascalGrammar<std::shared_ptr<Ast<MakeShared, PascalToken>>, base::TokenBuffer<PascalToken>::iterator_type, parser::LL1ParserGrammar>::type;
+using PascalLL1Parser = parser::Parser<PascLL1Grammar>;
 
 }  // namespace pascal
 }  // namespace languages
@@ -2,6 +2,7 @@
 #define KOLIBRI_SRC_PASCAL_PARSER_FACTORY_H_
 
 #include "languages/ast.h"
+#include "languages/ast_factory.h"
 #include "languages/ast_types.h"
 #include "languages/i_ast_factory.h"
 #include "languages/pascal/pascal_token.h"
@@ -10,18 +11,23 @@
 namespace languages {
 namespace pascal {
 
-class PascalParserFactory : public parser::IParserFactory<std::shared_ptr<Ast<MakeShared, PascalToken>>, PascalToken> {
+// Creates the AST through TAstFactory. With AstFactory instead of the IAstFactory interface, and
+// called statically by the parser, no call is virtual and the switches on the rule id fold away.
+template <typename TAstFactory>
+class BasicPascalParserFactory final : public parser::StaticParserFactory<BasicPascalParserFactory<TAstFactory>, std::shared_ptr<Ast<MakeShared, PascalToken>>, PascalToken> {
  public:
   using nonterm_type = std::shared_ptr<Ast<MakeShared, PascalToken>>;
   using term_type = PascalToken;
 
-  PascalParserFactory(IAstFactory<nonterm_type, term_type>& ast_factory) : ast_factory_(ast_factory) {}
+  BasicPascalParserFactory(TAstFactory& ast_factory) : ast_factory_(ast_factory) {}
 
   nonterm_type CreateNull() override { return ast_factory_.CreateNull(); }
 
-  nonterm_type CreateEmpty(parser::RuleId rule_id) override { return ast_factory_.CreateNop(); }
+  template <typename TRuleId>
+  nonterm_type CreateEmpty(TRuleId rule_id) { return ast_factory_.CreateNop(); }
 
-  nonterm_type CreateTerm(parser::RuleId rule_id, term_type term) override {
+  template <typename TRuleId>
+  nonterm_type CreateTerm(TRuleId rule_id, term_type term) {
     switch (rule_id) {
       case parser::RuleId::kRule4: {  // type_spec
         return ast_factory_.CreateRaw(term);
@@ -51,7 +57,8 @@ class PascalParserFactory : public parser::IParserFactory<std::shared_ptr<Ast<Ma
     // this should not happen
     return ast_factory_.CreateNull();
   }
-  nonterm_type CreateNonTerm(parser::RuleId rule_id, nonterm_type nonterm) override {
+  template <typename TRuleId>
+  nonterm_type CreateNonTerm(TRuleId rule_id, nonterm_type nonterm) {
     switch (rule_id) {
       case parser::RuleId::kRule5: {  // compound_statement
         assert(nonterm->GetTypeId() == AstTypeId::kAstRawListType);
@@ -66,7 +73,8 @@ class PascalParserFactory : public parser::IParserFactory<std::shared_ptr<Ast<Ma
     return ast_factory_.CreateNull();
   }
 
-  nonterm_type CreateTermNonTerm(parser::RuleId rule_id, term_type term, nonterm_type nonterm) override {
+  template <typename TRuleId>
+  nonterm_type CreateTermNonTerm(TRuleId rule_id, term_type term, nonterm_type nonterm) {
     switch (rule_id) {
       case parser::RuleId::kRule12: {  // factor
         return ast_factory_.CreateUnaryOp(term, nonterm);
@@ -78,7 +86,8 @@ class PascalParserFactory : public parser::IParserFactory<std::shared_ptr<Ast<Ma
     // this should not happen
     return ast_factory_.CreateNull();
   }
-  nonterm_type CreateNonTermNonTerm(parser::RuleId rule_id, nonterm_type lhs, nonterm_type rhs) override {
+  template <typename TRuleId>
+  nonterm_type CreateNonTermNonTerm(TRuleId rule_id, nonterm_type lhs, nonterm_type rhs) {
     switch (rule_id) {
       case parser::RuleId::kRule0: {  // program
         return ast_factory_.CreateProgram(lhs, rhs);
@@ -97,7 +106,8 @@ class PascalParserFactory : public parser::IParserFactory<std::shared_ptr<Ast<Ma
     return ast_factory_.CreateNull();
   }
 
-  nonterm_type CreateNonTermTermNonTerm(parser::RuleId rule_id, nonterm_type lhs, term_type term, nonterm_type rhs) override {
+  template <typename TRuleId>
+  nonterm_type CreateNonTermTermNonTerm(TRuleId rule_id, nonterm_type lhs, term_type term, nonterm_type rhs) {
     switch (rule_id) {
       case parser::RuleId::kRule8: {  // assignment_statement
         return ast_factory_.CreateBinaryOp(lhs, term, rhs);
@@ -118,7 +128,8 @@ class PascalParserFactory : public parser::IParserFactory<std::shared_ptr<Ast<Ma
     return ast_factory_.CreateNull();
   }
 
-  nonterm_type CreateNonTermList(parser::RuleId rule_id, std::vector<nonterm_type> nonterms) override {
+  template <typename TRuleId>
+  nonterm_type CreateNonTermList(TRuleId rule_id, std::vector<nonterm_type> nonterms) {
     switch (rule_id) {
       case parser::RuleId::kRule2: {  // declarations
         std::vector<nonterm_type> var_decls;
@@ -145,7 +156,8 @@ class PascalParserFactory : public parser::IParserFactory<std::shared_ptr<Ast<Ma
     return ast_factory_.CreateNull();
   }
 
-  nonterm_type CreateTermNonTermList(parser::RuleId rule_id, std::vector<term_type> terms, std::vector<nonterm_type> nonterms) override {
+  template <typename TRuleId>
+  nonterm_type CreateTermNonTermList(TRuleId rule_id, std::vector<term_type> terms, std::vector<nonterm_type> nonterms) {
     std::vector<term_type> id_terms;
 
     for (int i = 0; i < terms.size(); ++i) {
@@ -171,9 +183,12 @@ class PascalParserFactory : public parser::IParserFactory<std::shared_ptr<Ast<Ma
   }
 
  private:
-  IAstFactory<nonterm_type, term_type>& ast_factory_;
+  TAstFactory& ast_factory_;
 };
 
+using PascalParserFactory = BasicPascalParserFactory<IAstFactory<std::shared_ptr<Ast<MakeShared, PascalToken>>, PascalToken>>;
+using PascalStaticParserFactory = BasicPascalParserFactory<AstFactory<std::shared_ptr<Ast<MakeShared, PascalToken>>, PascalToken>>;
+
 }  // namespace pascal
 }  // namespace languages
 #endif
\ No newline at end of file
@@ -1,9 +1,13 @@
 #ifndef KOLIBRI_SRC_INTERPRETER_H_
 #define KOLIBRI_SRC_INTERPRETER_H_
 
+#include <assert.h>
+
 #include <iostream>
 #include <string>
+#include <string_view>
 
+#include "base/line_index.h"
 #include "languages/ast_types.h"
 #include "languages/i_ast_visitor.h"
 
@@ -17,7 +21,7 @@ class PrintAst {
 
   class Visitor : public IAstVisitor<TMakeType, term_type> {
    public:
-    Visitor(std::ostream& stream) : stream_(stream), node_id_(0) {}
+    Visitor(std::ostream& stream, const base::LineIndex* line_index) : stream_(stream), node_id_(0), line_index_(line_index) {}
 
     VisitorReturn Visit(AstProgram<TMakeType, term_type>& ast) override {
       auto program_id = ast.GetProgramId();
@@ -25,7 +29,7 @@ class PrintAst {
 
       auto& pname = dynamic_cast<AstId<MakeShared, term_type>&>(*program_id);
 
-      stream_ << "  node" << node_id_ << " [label=\"Program\n" << pname.GetName().GetValue() << "\"]" << std::endl;
+      stream_ << "  node" << node_id_ << " [label=\"Program\n" << pname.GetName().GetValue() << Where(pname.GetName().GetValue()) << "\"]" << std::endl;
       auto orig_count = node_id_;
 
       node_id_++;
@@ -59,7 +63,7 @@ class PrintAst {
       auto rood_node_id = node_id_;
       node_id_++;
       auto id = ast.GetId();
-      stream_ << "  node" << node_id_ << " [label=\"" << id.GetValue() << "\"]" << std::endl;
+      stream_ << "  node" << node_id_ << " [label=\"" << id.GetValue() << Where(id.GetValue()) << "\"]" << std::endl;
       stream_ << "  node" << rood_node_id << " -> node" << node_id_ << std::endl;
 
       node_id_++;
@@ -75,10 +79,10 @@ class PrintAst {
 
       switch (const_type) {
         case ConstType::kInteger:
-          stream_ << "  node" << node_id_ << " [label=\"(int)\n" << value.GetValue() << "\"]" << std::endl;
+          stream_ << "  node" << node_id_ << " [label=\"(int)\n" << value.GetValue() << Where(value.GetValue()) << "\"]" << std::endl;
           break;
         case ConstType::kReal:
-          stream_ << "  node" << node_id_ << " [label=\"(float)\n" << value.GetValue() << "\"]" << std::endl;
+          stream_ << "  node" << node_id_ << " [label=\"(float)\n" << value.GetValue() << Where(value.GetValue()) << "\"]" << std::endl;
           break;
         default:
           assert(true);
@@ -90,7 +94,7 @@ class PrintAst {
     VisitorReturn Visit(AstNop<TMakeType, term_type>& ast) override { stream_ << "  node" << node_id_ << " [label=\"Nop\"]" << std::endl;return VisitorReturn();   }
 
     VisitorReturn Visit(AstId<TMakeType, term_type>& ast) override {
-      stream_ << "  node" << node_id_ << " [label=\"Var:\\n" << ast.GetName().GetValue() << "\"]" << std::endl;
+      stream_ << "  node" << node_id_ << " [label=\"Var:\\n" << ast.GetName().GetValue() << Where(ast.GetName().GetValue()) << "\"]" << std::endl;
       return VisitorReturn();  
     }
 
@@ -99,7 +103,7 @@ class PrintAst {
 
       auto operand = ast.GetOperand();
 
-      stream_ << "  node" << node_id_ << " [label=\"(unary)\n" << op_val << "\"]" << std::endl;
+      stream_ << "  node" << node_id_ << " [label=\"(unary)\n" << op_val << Where(op_val) << "\"]" << std::endl;
       auto rood_node_id = node_id_;
       node_id_++;
 
@@ -127,7 +131,7 @@ class PrintAst {
       auto op_val = ast.GetOperator().GetValue();
 
       unsigned rood_node_id = node_id_;
-      stream_ << "  node" << rood_node_id << " [label=\"" << op_val << "\"]" << std::endl;
+      stream_ << "  node" << rood_node_id << " [label=\"" << op_val << Where(op_val) << "\"]" << std::endl;
 
       auto operand_lhs = ast.GetOperandLhs();
       node_id_++;
@@ -142,17 +146,28 @@ class PrintAst {
     }
 
    private:
+    // Location of a token value as label line. Only looked up when a line index is given.
+    std::string Where(std::string_view value) const {
+      if ((line_index_ == nullptr) || !line_index_->Contains(value.data())) {
+        return std::string();
+      }
+      auto location = line_index_->Locate(value.data());
+      return "\n@" + std::to_string(location.line) + ":" + std::to_string(location.column);
+    }
+
     std::ostream& stream_;
     unsigned node_id_;
+    const base::LineIndex* line_index_;
   };
 
-  void Print(std::ostream& stream, nonterm_type node) {
+  // Labels of nodes with a token get its line and column when the line index of the source is given.
+  void Print(std::ostream& stream, nonterm_type node, const base::LineIndex* line_index = nullptr) {
     stream << "digraph astgraph {" << std::endl;
     stream << "node [shape=circle, fontsize=12, fontname=\"Courier\", height=.1];" << std::endl;
     stream << "ranksep=.3;" << std::endl;
     stream << "edge [arrowsize=.5]" << std::endl;
     stream << std::endl;
-    Visitor visitor(stream);
+    Visitor visitor(stream, line_index);
     node->Accept(visitor);
     stream << "}" << std::endl;
   }
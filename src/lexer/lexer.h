@@ -12,7 +12,7 @@ class Lexer {
   
   class LexerIterator {
    public:
-    using value_type = value_type;
+    using value_type = typename Rules::value_type;
     using difference_type = void;
     using pointer = value_type*;
     using reference = value_type&;
@@ -0,0 +1,82 @@
+#ifndef KOLIBRI_SRC_LEXER_CHAR_CLASS_H_
+#define KOLIBRI_SRC_LEXER_CHAR_CLASS_H_
+
+#include <stdint.h>
+
+#include <array>
+
+#include "lexer/lexer_char_set.h"
+
+namespace lexer {
+
+// Bits of the builtin character classes. A predicate on builtin classes compiles down to one load
+// from kCharClasses and one AND with its mask.
+enum CharClassBits : uint8_t {
+  kCharClassDigit = 1 << 0,
+  kCharClassLowerCaseLetter = 1 << 1,
+  kCharClassUpperCaseLetter = 1 << 2,
+  kCharClassLetter = kCharClassLowerCaseLetter | kCharClassUpperCaseLetter,
+  kCharClassLetterOrDigit = kCharClassLetter | kCharClassDigit,
+};
+
+constexpr std::array<uint8_t, 256> MakeCharClasses() {
+  std::array<uint8_t, 256> classes{};
+  for (unsigned ch = '0'; ch <= '9'; ++ch) {
+    classes[ch] |= kCharClassDigit;
+  }
+  for (unsigned ch = 'a'; ch <= 'z'; ++ch) {
+    classes[ch] |= kCharClassLowerCaseLetter;
+  }
+  for (unsigned ch = 'A'; ch <= 'Z'; ++ch) {
+    classes[ch] |= kCharClassUpperCaseLetter;
+  }
+  return classes;
+}
+
+inline constexpr std::array<uint8_t, 256> kCharClasses = MakeCharClasses();
+
+// Maps every byte to its lower case counterpart. Only ASCII letters are changed.
+constexpr std::array<char, 256> MakeLowerCaseFold() {
+  std::array<char, 256> fold{};
+  for (unsigned ch = 0; ch < 256; ++ch) {
+    bool upper = ('A' <= ch) && (ch <= 'Z');
+    fold[ch] = static_cast<char>(upper ? ch - 'A' + 'a' : ch);
+  }
+  return fold;
+}
+
+inline constexpr std::array<char, 256> kLowerCaseFold = MakeLowerCaseFold();
+
+// Predicate which is true for every char of one of the builtin classes in Mask.
+template <uint8_t Mask>
+struct IsCharClass {
+  constexpr bool operator()(char ch) const { return (kCharClasses[static_cast<unsigned char>(ch)] & Mask) != 0; }
+};
+
+template <typename TPredicate>
+constexpr std::array<bool, 256> MakePredicateTable() {
+  std::array<bool, 256> table{};
+  TPredicate pred{};
+  for (unsigned ch = 0; ch < 256; ++ch) {
+    table[ch] = pred(static_cast<char>(ch));
+  }
+  return table;
+}
+
+// Custom character classes. The given constexpr predicate is evaluated for all 256 bytes at
+// compile time and afterwards answered by a single table lookup, e.g.
+//
+//   struct IsHexDigitSlow { constexpr bool operator()(char ch) const { ... } };
+//   using IsHexDigit = lexer::PredicateTable<IsHexDigitSlow>;
+template <typename TPredicate>
+struct PredicateTable {
+  static_assert(is_constexpr_predicate<TPredicate>::value, "PredicateTable needs a predicate which can be evaluated at compile time");
+
+  static constexpr std::array<bool, 256> kTable = MakePredicateTable<TPredicate>();
+
+  constexpr bool operator()(char ch) const { return kTable[static_cast<unsigned char>(ch)]; }
+};
+
+}  // namespace lexer
+
+#endif
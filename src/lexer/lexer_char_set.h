@@ -0,0 +1,74 @@
+#ifndef KOLIBRI_SRC_LEXER_CHAR_SET_H_
+#define KOLIBRI_SRC_LEXER_CHAR_SET_H_
+
+#include <stdint.h>
+
+#include <type_traits>
+
+namespace lexer {
+
+// A set of bytes which can be build and queried at compile time. It is used to
+// reason about predicates and matchers without running them on real input.
+class CharSet {
+ public:
+  constexpr CharSet() : bits_{0, 0, 0, 0} {}
+
+  static constexpr CharSet All() {
+    CharSet set;
+    for (unsigned i = 0; i < 4; ++i) {
+      set.bits_[i] = ~uint64_t{0};
+    }
+    return set;
+  }
+
+  constexpr void Insert(unsigned char ch) { bits_[ch >> 6] |= uint64_t{1} << (ch & 63); }
+
+  constexpr bool Contains(unsigned char ch) const { return (bits_[ch >> 6] >> (ch & 63)) & 1; }
+
+  constexpr bool IsEmpty() const { return (bits_[0] | bits_[1] | bits_[2] | bits_[3]) == 0; }
+
+  constexpr CharSet& operator|=(const CharSet& rhs) {
+    for (unsigned i = 0; i < 4; ++i) {
+      bits_[i] |= rhs.bits_[i];
+    }
+    return *this;
+  }
+
+  constexpr bool operator==(const CharSet& rhs) const {
+    for (unsigned i = 0; i < 4; ++i) {
+      if (bits_[i] != rhs.bits_[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+  constexpr bool operator!=(const CharSet& rhs) const { return !(*this == rhs); }
+
+ private:
+  uint64_t bits_[4];
+};
+
+// Evaluates a constexpr predicate for every byte and collects the accepted ones.
+template <typename TPredicate>
+constexpr CharSet MakeCharSet() {
+  CharSet set;
+  TPredicate pred{};
+  for (unsigned ch = 0; ch < 256; ++ch) {
+    if (pred(static_cast<char>(ch))) {
+      set.Insert(static_cast<unsigned char>(ch));
+    }
+  }
+  return set;
+}
+
+// true if MakeCharSet can evaluate TPredicate at compile time, i.e. it is default constructible
+// and called as a constant expression.
+template <typename TPredicate, typename = void>
+struct is_constexpr_predicate : std::false_type {};
+
+template <typename TPredicate>
+struct is_constexpr_predicate<TPredicate, std::enable_if_t<(MakeCharSet<TPredicate>(), true)>> : std::true_type {};
+
+}  // namespace lexer
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef KOLIBRI_SRC_LEXER_CONSTEXPR_H_
+#define KOLIBRI_SRC_LEXER_CONSTEXPR_H_
+
+#include <stddef.h>
+
+#include <array>
+#include <string_view>
+
+namespace lexer {
+
+// Lexing of sources which are known at compile time, e.g. string literals. The rules have to be
+// constexpr, which LexerRules with the matchers of lexer_rules.h and the language productions are.
+// Two passes are needed since the size of the array is a template argument:
+//
+//   static constexpr std::string_view kSource = "5+5*6";
+//   constexpr auto kTokens = LexToArray<CalcLexerRules::type, CountTokens<CalcLexerRules::type>(kSource)>(kSource);
+//
+// The source must outlive the tokens, they point into it.
+
+// Number of tokens in source. The end of file token is not counted.
+template <typename TRules>
+constexpr size_t CountTokens(std::string_view source) {
+  const char* it = source.data();
+  const char* end = source.data() + source.size();
+  const auto eof_token = TRules().Match(end, end);
+
+  TRules rules{};
+  size_t count = 0;
+  while (true) {
+    auto token = rules.Match(it, end);
+    it = rules.GetPosition();
+    if ((it == end) && (token == eof_token)) {
+      return count;
+    }
+    count++;
+  }
+}
+
+// The first N tokens of source. The end of file token is not part of the array. When the source
+// has less than N tokens the remaining elements are default constructed.
+template <typename TRules, size_t N>
+constexpr std::array<typename TRules::value_type, N> LexToArray(std::string_view source) {
+  const char* it = source.data();
+  const char* end = source.data() + source.size();
+  const auto eof_token = TRules().Match(end, end);
+
+  std::array<typename TRules::value_type, N> tokens;
+  TRules rules{};
+  for (size_t i = 0; i < N; ++i) {
+    auto token = rules.Match(it, end);
+    it = rules.GetPosition();
+    if ((it == end) && (token == eof_token)) {
+      break;
+    }
+    tokens[i] = token;
+  }
+  return tokens;
+}
+
+}  // namespace lexer
+
+#endif
@@ -0,0 +1,723 @@
+#ifndef KOLIBRI_SRC_LEXER_DFA_RULES_H_
+#define KOLIBRI_SRC_LEXER_DFA_RULES_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <array>
+#include <type_traits>
+
+#include "lexer/lexer_char_set.h"
+#include "lexer/lexer_rules.h"
+#include "lexer/lexer_traits.h"
+#include "lexer/lexer_transforms.h"
+
+namespace lexer {
+
+// ------------------------------------------------------------------------------------------------
+// MATCHER PROGRAMS
+// ------------------------------------------------------------------------------------------------
+
+// A matcher is flattened into a list of items. Each item consumes the input possessively, exactly
+// like the Parse() method of the matcher it was generated from.
+enum class DfaItemKind : uint8_t {
+  kOne,      // exactly one char of the set
+  kPlus,     // one or more chars of the set
+  kStar,     // zero or more chars of the set
+  kUntil,    // everything up to and including the pattern stored in the following kPattern items
+  kPattern,  // one char of a kUntil pattern
+};
+
+struct DfaItem {
+  constexpr DfaItem() : kind(DfaItemKind::kOne), set(), pattern_len(0) {}
+
+  DfaItemKind kind;
+  CharSet set;
+  unsigned pattern_len;
+};
+
+constexpr unsigned kDfaMaxItems = 64;
+constexpr unsigned kDfaMaxPatternLen = 23;  // the partial matches of a pattern are tracked in a 24 bit mask
+
+struct DfaProgram {
+  constexpr DfaProgram() : items(), size(0), never_matches(false), overflow(false) {}
+
+  constexpr void Add(DfaItemKind kind, CharSet set) {
+    if (size == kDfaMaxItems) {
+      overflow = true;
+      return;
+    }
+    items[size].kind = kind;
+    items[size].set = set;
+    size++;
+  }
+
+  constexpr void AddUntil(const DfaProgram& pattern) {
+    if ((pattern.size == 0) || (pattern.size > kDfaMaxPatternLen)) {
+      overflow = true;
+      return;
+    }
+    Add(DfaItemKind::kUntil, CharSet());
+    items[size - 1].pattern_len = pattern.size;
+    for (unsigned i = 0; i < pattern.size; ++i) {
+      Add(DfaItemKind::kPattern, pattern.items[i].set);
+    }
+  }
+
+  // index of the item which follows the given one
+  constexpr unsigned Next(unsigned item) const {
+    if (items[item].kind == DfaItemKind::kUntil) {
+      return item + 1 + items[item].pattern_len;
+    }
+    return item + 1;
+  }
+
+  DfaItem items[kDfaMaxItems];
+  unsigned size;
+  bool never_matches;  // e.g. an empty string which never consumes anything
+  bool overflow;
+};
+
+// Translates a matcher type into items. Only the matchers of lexer_rules.h are supported.
+template <typename TMatcher>
+struct DfaMatcher {
+  static_assert(sizeof(TMatcher) == 0, "DfaLexerRules: matcher is not supported");
+};
+
+template <typename TPredicate>
+struct DfaMatcher<MatcherPredicate<TPredicate>> {
+  static constexpr bool kFixedWidth = true;
+  static constexpr void Append(DfaProgram& program) { program.Add(DfaItemKind::kOne, MakeCharSet<TPredicate>()); }
+};
+
+template <typename TStringProvider, bool CaseInsensitive>
+struct DfaMatcher<MatcherString<TStringProvider, CaseInsensitive>> {
+  static constexpr bool kFixedWidth = true;
+  static constexpr void Append(DfaProgram& program) {
+    const char* cmp = TStringProvider::GetString();
+    if (*cmp == '\0') {
+      program.never_matches = true;
+    }
+    for (; *cmp != '\0'; cmp++) {
+      CharSet set;
+      if (CaseInsensitive) {
+        ToLowerCase to_lower_case{};
+        for (unsigned ch = 0; ch < 256; ++ch) {
+          if (to_lower_case(static_cast<char>(ch)) == to_lower_case(*cmp)) {
+            set.Insert(static_cast<unsigned char>(ch));
+          }
+        }
+      } else {
+        set.Insert(static_cast<unsigned char>(*cmp));
+      }
+      program.Add(DfaItemKind::kOne, set);
+    }
+  }
+};
+
+template <typename TPredicate>
+struct DfaMatcher<MatcherRangeByPredicate<TPredicate>> {
+  static constexpr bool kFixedWidth = false;
+  static constexpr void Append(DfaProgram& program) { program.Add(DfaItemKind::kPlus, MakeCharSet<TPredicate>()); }
+};
+
+template <typename TPredicate>
+struct DfaMatcher<MatcherSimdRangeByPredicate<TPredicate>> {
+  static constexpr bool kFixedWidth = false;
+  static constexpr void Append(DfaProgram& program) { program.Add(DfaItemKind::kPlus, MakeCharSet<TPredicate>()); }
+};
+
+template <typename TStartPredicate, typename TPredicate>
+struct DfaMatcher<MatcherIdentifier<TStartPredicate, TPredicate>> {
+  static constexpr bool kFixedWidth = false;
+  static constexpr void Append(DfaProgram& program) {
+    program.Add(DfaItemKind::kOne, MakeCharSet<TStartPredicate>());
+    program.Add(DfaItemKind::kStar, MakeCharSet<TPredicate>());
+  }
+};
+
+template <typename... TMatchers>
+struct DfaMatcher<MatcherSequence<TMatchers...>> {
+  static constexpr bool kFixedWidth = (DfaMatcher<TMatchers>::kFixedWidth && ...);
+  static constexpr void Append(DfaProgram& program) { (DfaMatcher<TMatchers>::Append(program), ...); }
+};
+
+template <typename TStartMatcher, typename TStopMatcher>
+struct DfaMatcher<MatcherRangeByStartStopDelimiter<TStartMatcher, TStopMatcher>> {
+  static_assert(DfaMatcher<TStopMatcher>::kFixedWidth, "DfaLexerRules: the stop matcher of a delimited range must have a fixed width");
+
+  static constexpr bool kFixedWidth = false;
+  static constexpr void Append(DfaProgram& program) {
+    DfaMatcher<TStartMatcher>::Append(program);
+    DfaProgram pattern;
+    DfaMatcher<TStopMatcher>::Append(pattern);
+    program.never_matches = program.never_matches || pattern.never_matches;
+    program.AddUntil(pattern);
+  }
+};
+
+template <typename TMatcher>
+constexpr DfaProgram MakeDfaProgram() {
+  DfaProgram program;
+  DfaMatcher<TMatcher>::Append(program);
+  return program;
+}
+
+// ------------------------------------------------------------------------------------------------
+// AUTOMATON
+// ------------------------------------------------------------------------------------------------
+
+constexpr unsigned kDfaMaxTransitions = 1u << 15;
+constexpr unsigned kDfaMaxStates = 1u << 10;
+
+// Layout of a transition entry: [0..15] next state, [16..23] accepted rule, [24] accepted after the byte was consumed
+constexpr uint32_t kDfaStateMask = 0xFFFF;
+constexpr unsigned kDfaRuleShift = 16;
+constexpr uint32_t kDfaNoRule = 0xFF;
+constexpr uint32_t kDfaAcceptAfter = 1u << 24;
+
+constexpr unsigned kDfaDeadState = 0;
+constexpr unsigned kDfaStartState = 1;
+
+// How the automaton chooses between rules which match at the same position.
+enum class DfaResolution {
+  kFirstMatch,    // the first rule in declaration order which matches wins, like LexerRules
+  kLongestMatch,  // the longest match wins, declaration order only breaks ties
+};
+
+// Result of BasicDfaLexerRules::Continue()
+enum class DfaContinuation {
+  kNeedsInput,  // the match may go on behind the given input
+  kSkipped,     // the match was skipped input, lexing goes on behind it
+  kTooLong,     // the match was a token or no rule matched, see CreateTooLong()
+};
+
+// Runs all matcher programs in lock step (product construction). With kFirstMatch the rules are
+// resolved with the same priority LexerRules uses: once a rule has accepted all rules declared
+// after it are dropped. With kLongestMatch all rules keep running until they are resolved and a
+// transition reports the longest of the matches which end on it.
+template <size_t NRules, DfaResolution Resolution = DfaResolution::kFirstMatch>
+class DfaBuilder {
+ public:
+  static_assert(NRules > 0, "DfaLexerRules: at least one rule is required");
+  static_assert(NRules < kDfaNoRule, "DfaLexerRules: too many rules");
+
+  constexpr explicit DfaBuilder(const std::array<DfaProgram, NRules>& programs)
+      : programs_(programs), representative_(), states_(), hashes_(), byte_class(), num_classes(0), num_states(0), transitions(), eof_accept(),
+        overflow(false) {
+    for (unsigned i = 0; i < NRules; ++i) {
+      overflow = overflow || programs_[i].overflow;
+    }
+    ComputeByteClasses();
+    Explore();
+  }
+
+  constexpr std::array<uint8_t, 256> ByteClasses() const {
+    std::array<uint8_t, 256> result{};
+    for (unsigned ch = 0; ch < 256; ++ch) {
+      result[ch] = byte_class[ch];
+    }
+    return result;
+  }
+
+  template <size_t N>
+  constexpr std::array<uint32_t, N> Transitions() const {
+    std::array<uint32_t, N> result{};
+    for (unsigned i = 0; i < N; ++i) {
+      result[i] = transitions[i];
+    }
+    return result;
+  }
+
+  template <size_t N>
+  constexpr std::array<uint8_t, N> EofAccept() const {
+    std::array<uint8_t, N> result{};
+    for (unsigned i = 0; i < N; ++i) {
+      result[i] = eof_accept[i];
+    }
+    return result;
+  }
+
+ private:
+  static constexpr uint32_t kRuleDead = 0xFFFFFFFF;
+  static constexpr uint32_t kRuleDone = 0xFFFFFFFE;
+
+  enum class Event { kNone, kBefore, kAfter };
+
+  struct RuleStep {
+    uint32_t state;
+    Event event;
+  };
+
+  static constexpr uint32_t Pack(unsigned item, uint32_t sub) { return item | (sub << 8); }
+
+  // Advances the program of a single rule by one byte.
+  static constexpr RuleStep Step(const DfaProgram& program, uint32_t state, unsigned char ch, bool first_step) {
+    unsigned item = state & 0xFF;
+    uint32_t sub = state >> 8;
+    while (true) {
+      if (item == program.size) {
+        // finished without consuming ch, an empty match is no match
+        return first_step ? RuleStep{kRuleDead, Event::kNone} : RuleStep{kRuleDone, Event::kBefore};
+      }
+      const DfaItem& current = program.items[item];
+      switch (current.kind) {
+        case DfaItemKind::kOne: {
+          if (!current.set.Contains(ch)) {
+            return {kRuleDead, Event::kNone};
+          }
+          item = program.Next(item);
+          if (item == program.size) {
+            return {kRuleDone, Event::kAfter};
+          }
+          return {Pack(item, 0), Event::kNone};
+        }
+        case DfaItemKind::kPlus: {
+          if (current.set.Contains(ch)) {
+            return {Pack(item, 1), Event::kNone};
+          }
+          if (sub == 0) {
+            return {kRuleDead, Event::kNone};
+          }
+          item = program.Next(item);
+          sub = 0;
+          break;  // ch is handled by the next item
+        }
+        case DfaItemKind::kStar: {
+          if (current.set.Contains(ch)) {
+            return {Pack(item, 1), Event::kNone};
+          }
+          item = program.Next(item);
+          sub = 0;
+          break;  // ch is handled by the next item
+        }
+        case DfaItemKind::kUntil: {
+          uint32_t partial = 0;
+          uint32_t candidates = sub | 1;  // a new occurrence of the pattern may start at every position
+          for (unsigned k = 0; k < current.pattern_len; ++k) {
+            if (((candidates >> k) & 1) && program.items[item + 1 + k].set.Contains(ch)) {
+              partial |= uint32_t{1} << (k + 1);
+            }
+          }
+          if ((partial >> current.pattern_len) & 1) {
+            item = program.Next(item);
+            if (item == program.size) {
+              return {kRuleDone, Event::kAfter};
+            }
+            return {Pack(item, 0), Event::kNone};
+          }
+          return {Pack(item, partial), Event::kNone};
+        }
+        case DfaItemKind::kPattern: {
+          return {kRuleDead, Event::kNone};  // not reachable
+        }
+      }
+    }
+  }
+
+  // Checks whether a rule accepts when the input ends in the given state.
+  static constexpr bool AcceptsAtEnd(const DfaProgram& program, uint32_t state) {
+    unsigned item = state & 0xFF;
+    uint32_t sub = state >> 8;
+    while (item < program.size) {
+      bool empty_allowed = program.items[item].kind == DfaItemKind::kStar;
+      bool satisfied = (program.items[item].kind == DfaItemKind::kPlus) && (sub != 0);
+      if (!empty_allowed && !satisfied) {
+        return false;
+      }
+      item = program.Next(item);
+      sub = 0;
+    }
+    return true;
+  }
+
+  static constexpr bool IsLive(uint32_t state) { return (state != kRuleDead) && (state != kRuleDone); }
+
+  constexpr void ComputeByteClasses() {
+    num_classes = 1;
+    for (unsigned r = 0; r < NRules; ++r) {
+      for (unsigned i = 0; i < programs_[r].size; ++i) {
+        Refine(programs_[r].items[i].set);
+      }
+    }
+    bool seen[256] = {};
+    for (unsigned ch = 0; ch < 256; ++ch) {
+      if (!seen[byte_class[ch]]) {
+        seen[byte_class[ch]] = true;
+        representative_[byte_class[ch]] = static_cast<unsigned char>(ch);
+      }
+    }
+  }
+
+  // Splits every byte class in the part which is inside the set and the one which is not.
+  constexpr void Refine(const CharSet& set) {
+    int remap[256][2] = {};
+    for (unsigned i = 0; i < 256; ++i) {
+      remap[i][0] = -1;
+      remap[i][1] = -1;
+    }
+    unsigned next_class = 0;
+    for (unsigned ch = 0; ch < 256; ++ch) {
+      int& target = remap[byte_class[ch]][set.Contains(static_cast<unsigned char>(ch)) ? 1 : 0];
+      if (target < 0) {
+        target = static_cast<int>(next_class++);
+      }
+      byte_class[ch] = static_cast<uint8_t>(target);
+    }
+    num_classes = next_class;
+  }
+
+  static constexpr uint64_t Hash(const uint32_t* state) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned r = 0; r < NRules; ++r) {
+      hash = (hash ^ state[r]) * 1099511628211ull;
+    }
+    return hash;
+  }
+
+  constexpr unsigned FindOrAdd(const uint32_t* state) {
+    bool any_live = false;
+    for (unsigned r = 0; r < NRules; ++r) {
+      any_live = any_live || IsLive(state[r]);
+    }
+    if (!any_live) {
+      return kDfaDeadState;
+    }
+
+    uint64_t hash = Hash(state);
+    for (unsigned s = kDfaStartState; s < num_states; ++s) {
+      if (hashes_[s] != hash) {
+        continue;
+      }
+      bool equal = true;
+      for (unsigned r = 0; r < NRules; ++r) {
+        equal = equal && (states_[s][r] == state[r]);
+      }
+      if (equal) {
+        return s;
+      }
+    }
+
+    if ((num_states == kDfaMaxStates) || ((num_states + 1) * num_classes > kDfaMaxTransitions)) {
+      overflow = true;
+      return kDfaDeadState;
+    }
+    for (unsigned r = 0; r < NRules; ++r) {
+      states_[num_states][r] = state[r];
+    }
+    hashes_[num_states] = hash;
+    return num_states++;
+  }
+
+  constexpr void Explore() {
+    // state 0 is the dead state, every rule has failed or has been resolved
+    for (unsigned r = 0; r < NRules; ++r) {
+      states_[kDfaDeadState][r] = kRuleDead;
+    }
+    num_states = 1;
+
+    uint32_t start[NRules] = {};
+    for (unsigned r = 0; r < NRules; ++r) {
+      start[r] = programs_[r].never_matches || (programs_[r].size == 0) ? kRuleDead : Pack(0, 0);
+    }
+    if (FindOrAdd(start) != kDfaStartState) {
+      overflow = true;  // no rule can match at all
+      return;
+    }
+
+    for (unsigned c = 0; c < num_classes; ++c) {
+      transitions[kDfaDeadState * num_classes + c] = kDfaDeadState | (kDfaNoRule << kDfaRuleShift);
+    }
+    eof_accept[kDfaDeadState] = kDfaNoRule;
+
+    for (unsigned s = kDfaStartState; (s < num_states) && !overflow; ++s) {
+      for (unsigned c = 0; c < num_classes; ++c) {
+        uint32_t next[NRules] = {};
+        uint32_t accepted = kDfaNoRule;
+        Event event = Event::kNone;
+        for (unsigned r = 0; r < NRules; ++r) {
+          next[r] = kRuleDead;
+        }
+        for (unsigned r = 0; r < NRules; ++r) {
+          uint32_t current = states_[s][r];
+          if (!IsLive(current)) {
+            next[r] = current;
+            continue;
+          }
+          RuleStep step = Step(programs_[r], current, representative_[c], s == kDfaStartState);
+          next[r] = step.state;
+          if (step.event == Event::kNone) {
+            continue;
+          }
+          if (Resolution == DfaResolution::kFirstMatch) {
+            // every rule declared later has a lower priority
+            accepted = r;
+            event = step.event;
+            break;
+          }
+          // a match which includes the byte is longer than one which ends before it
+          if ((accepted == kDfaNoRule) || ((event == Event::kBefore) && (step.event == Event::kAfter))) {
+            accepted = r;
+            event = step.event;
+          }
+        }
+        unsigned target = FindOrAdd(next);
+        transitions[s * num_classes + c] = target | (accepted << kDfaRuleShift) | (event == Event::kAfter ? kDfaAcceptAfter : 0);
+      }
+
+      eof_accept[s] = kDfaNoRule;
+      for (unsigned r = 0; r < NRules; ++r) {
+        if (IsLive(states_[s][r]) && AcceptsAtEnd(programs_[r], states_[s][r])) {
+          eof_accept[s] = static_cast<uint8_t>(r);
+          break;
+        }
+      }
+    }
+  }
+
+  std::array<DfaProgram, NRules> programs_;
+  unsigned char representative_[256];
+  uint32_t states_[kDfaMaxStates][NRules];
+  uint64_t hashes_[kDfaMaxStates];
+
+ public:
+  uint8_t byte_class[256];
+  unsigned num_classes;
+  unsigned num_states;
+  uint32_t transitions[kDfaMaxTransitions];
+  uint8_t eof_accept[kDfaMaxStates];
+  bool overflow;
+};
+
+// The compiled automaton of a list of matchers.
+template <DfaResolution Resolution, typename... TMatchers>
+struct DfaTables {
+  static constexpr DfaBuilder<sizeof...(TMatchers), Resolution> kBuilder{std::array<DfaProgram, sizeof...(TMatchers)>{MakeDfaProgram<TMatchers>()...}};
+  static_assert(!kBuilder.overflow, "DfaLexerRules: the rules are too complex to be compiled into a DFA");
+
+  static constexpr unsigned kNumClasses = kBuilder.num_classes;
+  static constexpr unsigned kNumStates = kBuilder.num_states;
+  static constexpr std::array<uint8_t, 256> kByteClass = kBuilder.ByteClasses();
+  static constexpr std::array<uint32_t, kNumStates * kNumClasses> kTransitions = kBuilder.template Transitions<kNumStates * kNumClasses>();
+  static constexpr std::array<uint8_t, kNumStates> kEofAccept = kBuilder.template EofAccept<kNumStates>();
+};
+
+// ------------------------------------------------------------------------------------------------
+// RULES
+// ------------------------------------------------------------------------------------------------
+
+// Dispatches an accepted rule index to the production of the rule.
+template <typename TValue, typename... TRules>
+struct DfaRuleActions {
+  using create_function = TValue (*)(const char*, const char*);
+
+  template <typename TRule>
+  static TValue Create(const char* begin, const char* end) {
+    TRule rule;
+    return rule.Create(begin, end);
+  }
+
+  template <typename TRule>
+  static constexpr create_function CreateFunction() {
+    if constexpr (is_skip_production_class<typename TRule::production_type>::value) {
+      return nullptr;
+    } else {
+      return &Create<TRule>;
+    }
+  }
+
+  static constexpr bool kIsSkip[] = {is_skip_production_class<typename TRules::production_type>::value...};
+  static constexpr create_function kCreate[] = {CreateFunction<TRules>()...};
+};
+
+// The rules are compiled into a single transition table at compile time, so every input byte costs
+// one table lookup instead of one call per rule. See DfaLexerRules and LongestMatchLexerRules.
+template <DfaResolution Resolution, typename TProductionUNK, typename TProductionEOF, typename... TRules>
+class BasicDfaLexerRules {
+ public:
+  using value_type = typename TProductionUNK::value_type;  // Use value type of first factory
+
+  value_type Match(const char* begin, const char* end) {
+    examined_end_ = begin;
+    while (true) {
+      token_begin_ = begin;
+      hit_end_ = false;
+
+      // reached end
+      if (begin == end) {
+        it_ = end;
+        hit_end_ = true;
+        examined_end_ = end;
+        SaveScan(kDfaStartState, 0, kDfaNoRule, 0);
+        return TProductionEOF().Create(begin, end);
+      }
+
+      const char* rule_end = begin;
+      uint32_t rule = Scan(begin, end, rule_end);
+      if (rule == kDfaNoRule) {
+        return CreateUnknown(begin, end);
+      }
+
+      it_ = rule_end;
+      if (actions::kIsSkip[rule]) {
+        begin = rule_end;
+        continue;
+      }
+      return actions::kCreate[rule](begin, rule_end);
+    }
+  }
+
+  const char* GetPosition() { return it_; }
+
+  // True when the last call of Match() had to look at end to decide on the token. With more input
+  // behind end the token could be a different one. Used by the StreamLexer.
+  bool HitEnd() const { return hit_end_; }
+
+  // Begin of the last token, i.e. behind all skipped input.
+  const char* GetTokenBegin() const { return token_begin_; }
+
+  // Behind the last byte the last call of Match() looked at, including skipped input and the
+  // bytes read ahead of the token. The token only depends on the input in front of it. Used by the
+  // IncrementalLexer.
+  const char* GetExaminedEnd() const { return examined_end_; }
+
+  // Continues the last scan of Match() which hit the end with the input [begin, end) following it.
+  // The input in front of begin isn't looked at again, so it doesn't have to be kept. Used by the
+  // StreamLexer for matches which are too long to be kept in memory, e.g. long comments.
+  //
+  // Returns kNeedsInput until the match is decided, afterwards GetPosition() is where lexing goes
+  // on. A match which can't be continued at end of the input is decided with eof.
+  DfaContinuation Continue(const char* begin, const char* end, bool eof) {
+    unsigned state = resume_state_;
+    uint32_t rule = resume_rule_;
+    size_t rule_length = resume_rule_length_;
+    for (const char* pos = begin;; ++pos) {
+      size_t length = resume_length_ + static_cast<size_t>(pos - begin);
+      if (pos == end) {
+        if (!eof) {
+          SaveScan(state, length, rule, rule_length);
+          return DfaContinuation::kNeedsInput;
+        }
+        if (tables::kEofAccept[state] != kDfaNoRule) {
+          Accept(tables::kEofAccept[state], length, rule, rule_length);
+        }
+        return Decide(rule, rule_length, begin, pos);
+      }
+      uint32_t entry = tables::kTransitions[state * tables::kNumClasses + tables::kByteClass[static_cast<unsigned char>(*pos)]];
+      uint32_t accepted = (entry >> kDfaRuleShift) & kDfaNoRule;
+      if (accepted != kDfaNoRule) {
+        Accept(accepted, (entry & kDfaAcceptAfter) ? length + 1 : length, rule, rule_length);
+      }
+      state = entry & kDfaStateMask;
+      if (state == kDfaDeadState) {
+        return Decide(rule, rule_length, begin, pos);
+      }
+    }
+  }
+
+  // Token of a match which was too long to be kept, [begin, end) is the part which was kept.
+  value_type CreateTooLong(const char* begin, const char* end) { return TProductionUNK().Create(begin, end); }
+
+ private:
+  using tables = DfaTables<Resolution, typename TRules::matcher_type...>;
+  using actions = DfaRuleActions<value_type, TRules...>;
+  using unknown_traits = unknown_production_traits<TProductionUNK>;
+
+  // Runs the automaton from begin. Returns the accepted rule and its end or kDfaNoRule.
+  uint32_t Scan(const char* begin, const char* end, const char*& rule_end) {
+    uint32_t rule = kDfaNoRule;
+    unsigned state = kDfaStartState;
+    for (const char* pos = begin;; ++pos) {
+      if (pos == end) {
+        hit_end_ = true;
+        examined_end_ = end;
+        SaveScan(state, static_cast<size_t>(end - begin), rule, rule == kDfaNoRule ? 0 : static_cast<size_t>(rule_end - begin));
+        if (tables::kEofAccept[state] != kDfaNoRule) {
+          Accept(tables::kEofAccept[state], pos, rule, rule_end);
+        }
+        return rule;
+      }
+      uint32_t entry = tables::kTransitions[state * tables::kNumClasses + tables::kByteClass[static_cast<unsigned char>(*pos)]];
+      uint32_t accepted = (entry >> kDfaRuleShift) & kDfaNoRule;
+      if (accepted != kDfaNoRule) {
+        Accept(accepted, (entry & kDfaAcceptAfter) ? pos + 1 : pos, rule, rule_end);
+      }
+      state = entry & kDfaStateMask;
+      if (state == kDfaDeadState) {
+        examined_end_ = std::max(examined_end_, pos + 1);
+        return rule;
+      }
+    }
+  }
+
+  // Where Continue() picks the scan up, lengths are counted from the begin of the scan.
+  void SaveScan(unsigned state, size_t length, uint32_t rule, size_t rule_length) {
+    resume_state_ = state;
+    resume_length_ = length;
+    resume_rule_ = rule;
+    resume_rule_length_ = rule_length;
+  }
+
+  // The end of the match is still known if it lies in the input given to Continue(). Otherwise all
+  // input up to stop belongs to the too long match.
+  DfaContinuation Decide(uint32_t rule, size_t rule_length, const char* begin, const char* stop) {
+    bool known_end = (rule != kDfaNoRule) && (rule_length >= resume_length_);
+    it_ = known_end ? begin + (rule_length - resume_length_) : stop;
+    return (known_end && actions::kIsSkip[rule]) ? DfaContinuation::kSkipped : DfaContinuation::kTooLong;
+  }
+
+  // A later accept always ends at or behind the recorded one. With kFirstMatch it also has a higher
+  // priority. With kLongestMatch a match of the same length only wins when declared earlier. The
+  // end is a pointer or a length.
+  template <typename TEnd>
+  static void Accept(uint32_t accepted, TEnd accepted_end, uint32_t& rule, TEnd& rule_end) {
+    if ((Resolution == DfaResolution::kFirstMatch) || (rule == kDfaNoRule) || (accepted_end != rule_end) || (accepted < rule)) {
+      rule = accepted;
+      rule_end = accepted_end;
+    }
+  }
+
+  // One byte which no rule matches. See CoalesceUnknown for the recovery mode.
+  value_type CreateUnknown(const char* begin, const char* end) {
+    it_ = begin + 1;
+    if constexpr (unknown_traits::kCoalesce) {
+      if ((unknown_traits::kErrorBudget != 0) && (errors_ == unknown_traits::kErrorBudget)) {
+        it_ = end;
+        return TProductionEOF().Create(end, end);
+      }
+      errors_++;
+
+      const char* rule_end;
+      while ((it_ != end) && (Scan(it_, end, rule_end) == kDfaNoRule)) {
+        ++it_;
+      }
+      hit_end_ = hit_end_ || (it_ == end);
+    }
+    return TProductionUNK().Create(begin, it_);
+  }
+
+  const char* it_ = nullptr;
+  const char* token_begin_ = nullptr;
+  const char* examined_end_ = nullptr;
+  bool hit_end_ = false;
+  unsigned resume_state_ = kDfaStartState;  // state of the last scan which hit the end, see Continue()
+  size_t resume_length_ = 0;
+  uint32_t resume_rule_ = kDfaNoRule;
+  size_t resume_rule_length_ = 0;
+  size_t errors_ = 0;  // unknown tokens so far, only counted in the recovery mode
+};
+
+// Drop-in replacement for LexerRules. The produced tokens are the same as the ones of LexerRules
+// with the same rule list.
+template <typename TProductionUNK, typename TProductionEOF, typename... TRules>
+class DfaLexerRules : public BasicDfaLexerRules<DfaResolution::kFirstMatch, TProductionUNK, TProductionEOF, TRules...> {};
+
+// Maximal munch: the rule with the longest match wins and the declaration order only breaks ties,
+// e.g. ":=" is an assignment even when the rule for ':' is declared first. All rules are advanced
+// together in the same table driven scan, no matcher is run twice from the same start.
+template <typename TProductionUNK, typename TProductionEOF, typename... TRules>
+class LongestMatchLexerRules : public BasicDfaLexerRules<DfaResolution::kLongestMatch, TProductionUNK, TProductionEOF, TRules...> {};
+
+}  // namespace lexer
+#endif
@@ -0,0 +1,243 @@
+#ifndef KOLIBRI_SRC_LEXER_INCREMENTAL_H_
+#define KOLIBRI_SRC_LEXER_INCREMENTAL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace lexer {
+
+// Keeps the tokens of a text up to date while the text is edited, e.g. by an editor.
+//
+// An edit is lexed again from the last tokens in front of it until the new tokens meet the old
+// token stream behind the edit, i.e. until Match() is called at a position it was called at
+// before. From there on lexing is a deterministic function of the unchanged text, so the old
+// tokens are kept. The work per edit depends on the size of the edit, not on the size of the text.
+//
+// Tokens are stored as offsets into the text. The offsets behind an edit are shifted lazily, the
+// shift is applied while later edits pass by, so it costs the distance between two edits. Tokens
+// returned by operator[] point into the text and are valid until the next edit.
+//
+// Matching a token may look a few bytes behind its end. Every token records how far Match() looked,
+// lexing starts again at the first token which looked into the edit. Tokens which looked up to the
+// end of the text, e.g. an unterminated comment, are matched again on every edit behind them. Rules
+// have to report both by GetExaminedEnd() and HitEnd(), which DfaLexerRules does.
+template <typename Rules>
+class IncrementalLexer {
+ public:
+  using value_type = typename Rules::value_type;
+  using id_type = typename value_type::id_type;
+
+  // The tokens [first, first + removed) of the old stream were replaced by the tokens
+  // [first, first + inserted) of the new stream.
+  struct Change {
+    size_t first;
+    size_t removed;
+    size_t inserted;
+  };
+
+  explicit IncrementalLexer(std::string text) : text_(std::move(text)), entries_(), shift_index_(0), shift_(0), first_hit_end_(0), max_examined_(0) {
+    std::vector<Entry> entries;
+    LexUntilSync(0, 0, 0, 0, 0, entries);
+    entries_ = std::move(entries);
+    first_hit_end_ = FindHitEnd(0);
+  }
+
+  IncrementalLexer(IncrementalLexer const&) = delete;
+  IncrementalLexer& operator=(IncrementalLexer const&) = delete;
+
+  // Replaces removed bytes at offset by inserted and updates the tokens.
+  Change Apply(size_t offset, size_t removed, std::string_view inserted) {
+    offset = std::min(offset, text_.size());
+    removed = std::min(removed, text_.size() - offset);
+    ptrdiff_t delta = static_cast<ptrdiff_t>(inserted.size()) - static_cast<ptrdiff_t>(removed);
+
+    size_t first = FirstExamining(offset);
+    ApplyShiftUntil(first);
+
+    text_.replace(offset, removed, inserted.data(), inserted.size());
+    first = FirstChangedHitEnd(first);
+
+    std::vector<Entry> entries;
+    size_t start = first < entries_.size() ? GetStart(first) : GetEnd(first);
+    size_t sync = LexUntilSync(start, first, offset + removed, offset + inserted.size(), delta, entries);
+
+    // the kept tokens behind the edit move by delta
+    ApplyShiftUntil(sync);
+    if (shift_ == 0) {
+      shift_index_ = sync;
+    } else {
+      for (size_t i = sync; i < shift_index_; ++i) {
+        entries_[i].start = static_cast<size_t>(static_cast<ptrdiff_t>(entries_[i].start) + delta);
+      }
+    }
+    shift_ += delta;
+
+    size_t removed_tokens = sync - first;
+    entries_.erase(entries_.begin() + first, entries_.begin() + sync);
+    entries_.insert(entries_.begin() + first, entries.begin(), entries.end());
+    shift_index_ = shift_index_ - removed_tokens + entries.size();
+
+    if (first_hit_end_ >= first) {
+      auto hit_end = std::find_if(entries.begin(), entries.end(), [](const Entry& entry) { return entry.hit_end; });
+      if (hit_end != entries.end()) {
+        first_hit_end_ = first + static_cast<size_t>(hit_end - entries.begin());
+      } else if (first_hit_end_ >= sync) {
+        first_hit_end_ = first_hit_end_ - removed_tokens + entries.size();
+      } else {
+        first_hit_end_ = FindHitEnd(first + entries.size());  // rare, an unterminated token was closed
+      }
+    }
+    return {first, removed_tokens, entries.size()};
+  }
+
+  size_t size() const { return entries_.size(); }
+
+  value_type operator[](size_t index) const {
+    const Entry& entry = entries_[index];
+    return value_type(entry.id, text_.data() + GetStart(index) + entry.skip, entry.length);
+  }
+
+  const std::string& GetText() const { return text_; }
+
+ private:
+  struct Entry {
+    size_t start;       // position Match() was called at
+    uint32_t skip;      // skipped bytes in front of the token
+    uint32_t length;    // length of the token
+    uint32_t examined;  // bytes from start Match() looked at
+    id_type id;
+    bool hit_end;  // matching looked up to the end of the text
+  };
+
+  size_t GetStart(size_t index) const {
+    size_t start = entries_[index].start;
+    return index >= shift_index_ ? static_cast<size_t>(static_cast<ptrdiff_t>(start) + shift_) : start;
+  }
+
+  // Position Match() was called at behind the entries in front of index.
+  size_t GetEnd(size_t index) const {
+    if (index == 0) {
+      return 0;
+    }
+    const Entry& entry = entries_[index - 1];
+    return GetStart(index - 1) + entry.skip + entry.length;
+  }
+
+  void ApplyShiftUntil(size_t index) {
+    index = std::min(index, entries_.size());
+    if (shift_ == 0) {
+      shift_index_ = std::max(shift_index_, index);
+      return;
+    }
+    for (; shift_index_ < index; ++shift_index_) {
+      entries_[shift_index_].start = static_cast<size_t>(static_cast<ptrdiff_t>(entries_[shift_index_].start) + shift_);
+    }
+  }
+
+  size_t FirstStartNotBefore(size_t offset) const {
+    size_t lo = 0;
+    size_t hi = entries_.size();
+    while (lo < hi) {
+      size_t mid = lo + (hi - lo) / 2;
+      if (GetStart(mid) < offset) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  }
+
+  // Index of the first entry whose examined bytes reach offset, i.e. which may be different after an
+  // edit at offset. Entries which hit the end of the text are checked by FirstChangedHitEnd().
+  size_t FirstExamining(size_t offset) const {
+    size_t first = FirstStartNotBefore(offset);
+    for (size_t index = first; (index > 0) && (GetStart(index - 1) + max_examined_ > offset); --index) {
+      const Entry& entry = entries_[index - 1];
+      if (!entry.hit_end && (GetStart(index - 1) + entry.examined > offset)) {
+        first = index - 1;
+      }
+    }
+    return first;
+  }
+
+  // Index of the first entry from index on which hit the end of the text or size().
+  size_t FindHitEnd(size_t index) const {
+    while ((index < entries_.size()) && !entries_[index].hit_end) {
+      index++;
+    }
+    return index;
+  }
+
+  // Tokens in front of first which hit the end of the text may be different now. Returns the
+  // index of the first of them which changed or first.
+  size_t FirstChangedHitEnd(size_t first) {
+    Rules rules;
+    const char* data = text_.data();
+    for (size_t index = first_hit_end_; index < first; index = FindHitEnd(index + 1)) {
+      const Entry& entry = entries_[index];
+      size_t start = GetStart(index);
+      value_type token = rules.Match(data + start, data + text_.size());
+      auto value = token.GetValue();
+      bool same = (token.GetId() == entry.id) && (value.data() == data + start + entry.skip) && (value.size() == entry.length);
+      if (!same || !rules.HitEnd()) {
+        return index;
+      }
+    }
+    return first;
+  }
+
+  // Lexes the new text from start into entries until Match() is called at the start of an old
+  // token behind the edit. Old starts from edit_end on are moved by delta, new positions from
+  // new_edit_end on are unchanged text. Returns the index of the first old token which is kept.
+  size_t LexUntilSync(size_t start, size_t old_index, size_t edit_end, size_t new_edit_end, ptrdiff_t delta, std::vector<Entry>& entries) {
+    const char* data = text_.data();
+    const char* end = data + text_.size();
+    const value_type eof_token = Rules().Match(end, end);
+
+    Rules rules;
+    size_t pos = start;
+    while (true) {
+      if (pos >= new_edit_end) {
+        while ((old_index < entries_.size()) && ((GetStart(old_index) < edit_end) ||
+                                                 (static_cast<ptrdiff_t>(GetStart(old_index)) + delta < static_cast<ptrdiff_t>(pos)))) {
+          old_index++;
+        }
+        if ((old_index < entries_.size()) && (static_cast<ptrdiff_t>(GetStart(old_index)) + delta == static_cast<ptrdiff_t>(pos))) {
+          return old_index;
+        }
+      }
+
+      value_type token = rules.Match(data + pos, end);
+      const char* next = rules.GetPosition();
+      if ((next == end) && (token == eof_token)) {
+        return entries_.size();
+      }
+      auto value = token.GetValue();
+      auto examined = static_cast<uint32_t>(rules.GetExaminedEnd() - (data + pos));
+      entries.push_back(
+          {pos, static_cast<uint32_t>(value.data() - (data + pos)), static_cast<uint32_t>(value.size()), examined, token.GetId(), rules.HitEnd()});
+      if (!rules.HitEnd()) {
+        max_examined_ = std::max(max_examined_, static_cast<size_t>(examined));
+      }
+      pos = static_cast<size_t>(next - data);
+    }
+  }
+
+  std::string text_;
+  std::vector<Entry> entries_;
+  size_t shift_index_;  // the starts of all entries from shift_index_ on are off by shift_
+  ptrdiff_t shift_;
+  size_t first_hit_end_;  // index of the first entry which hit the end of the text or size()
+  size_t max_examined_;   // most bytes an entry which didn't hit the end looked at, never shrinks
+};
+
+}  // namespace lexer
+
+#endif
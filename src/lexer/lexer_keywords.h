@@ -0,0 +1,131 @@
+#ifndef KOLIBRI_SRC_LEXER_KEYWORDS_H_
+#define KOLIBRI_SRC_LEXER_KEYWORDS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lexer/lexer_transforms.h"
+
+namespace lexer {
+
+// A keyword of a KeywordTable. The id is returned when the keyword is found.
+template <auto Id, typename TStringProvider>
+struct Keyword {
+  static constexpr auto kId = Id;
+  using string_provider = TStringProvider;
+};
+
+template <bool CaseInsensitive>
+struct KeywordHash {
+  static constexpr char Fold(char ch) {
+    if (CaseInsensitive) {
+      return ToLowerCase{}(ch);
+    }
+    return ch;
+  }
+
+  static constexpr uint32_t Hash(const char* str, size_t len, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (size_t i = 0; i < len; ++i) {
+      hash = (hash ^ static_cast<unsigned char>(Fold(str[i]))) * 16777619u;
+    }
+    return hash ^ (hash >> 15);
+  }
+};
+
+// Places the keywords in a table of twice their number. The first seed for which every keyword
+// gets its own slot is used.
+template <bool CaseInsensitive, size_t NKeywords>
+struct KeywordLayout {
+  static constexpr size_t TableSize() {
+    size_t size = 1;
+    while (size < 2 * NKeywords) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  static constexpr size_t kTableSize = TableSize();
+  static constexpr uint32_t kMaxSeed = 1u << 16;
+
+  constexpr explicit KeywordLayout(const char* const (&strings)[NKeywords]) : seed(0), max_len(0), lens(), slots(), perfect(false) {
+    for (size_t k = 0; k < NKeywords; ++k) {
+      size_t len = 0;
+      while (strings[k][len] != '\0') {
+        len++;
+      }
+      lens[k] = len;
+      max_len = len > max_len ? len : max_len;
+    }
+
+    for (; (seed < kMaxSeed) && !perfect; ++seed) {
+      perfect = true;
+      for (size_t i = 0; i < kTableSize; ++i) {
+        slots[i] = -1;
+      }
+      for (size_t k = 0; (k < NKeywords) && perfect; ++k) {
+        int& slot = slots[KeywordHash<CaseInsensitive>::Hash(strings[k], lens[k], seed) & (kTableSize - 1)];
+        perfect = slot < 0;  // fails for duplicated keywords too
+        slot = static_cast<int>(k);
+      }
+    }
+    seed--;
+  }
+
+  uint32_t seed;
+  size_t max_len;
+  size_t lens[NKeywords];
+  int slots[kTableSize];
+  bool perfect;
+};
+
+// Classifies an already scanned identifier as one of the given keywords. The keywords are placed
+// in a table by a perfect hash which is searched at compile time, so a lookup costs one pass over
+// the identifier to hash it and one compare against the keyword in the hashed slot.
+template <bool CaseInsensitive, typename... TKeywords>
+class KeywordTable {
+ public:
+  // Returns the id of the keyword between begin and end or the given default id.
+  template <typename TId>
+  static constexpr TId Find(const char* begin, const char* end, TId default_id) {
+    constexpr TId kIds[] = {static_cast<TId>(TKeywords::kId)...};
+    int index = IndexOf(begin, end);
+    if (index < 0) {
+      return default_id;
+    }
+    return kIds[index];
+  }
+
+  // Returns the index of the keyword between begin and end or -1.
+  static constexpr int IndexOf(const char* begin, const char* end) {
+    using hash = KeywordHash<CaseInsensitive>;
+    size_t len = static_cast<size_t>(end - begin);
+    if ((len == 0) || (len > kLayout.max_len)) {
+      return -1;
+    }
+    int index = kLayout.slots[hash::Hash(begin, len, kLayout.seed) & (layout::kTableSize - 1)];
+    if ((index < 0) || (kLayout.lens[index] != len)) {
+      return -1;
+    }
+    const char* cmp = kStrings[index];
+    for (size_t i = 0; i < len; ++i) {
+      if (hash::Fold(cmp[i]) != hash::Fold(begin[i])) {
+        return -1;
+      }
+    }
+    return index;
+  }
+
+ private:
+  static_assert(sizeof...(TKeywords) > 0, "KeywordTable: at least one keyword is required");
+
+  using layout = KeywordLayout<CaseInsensitive, sizeof...(TKeywords)>;
+
+  static constexpr const char* kStrings[] = {TKeywords::string_provider::GetString()...};
+  static constexpr layout kLayout{kStrings};
+  static_assert(kLayout.perfect, "KeywordTable: no perfect hash found, are there duplicated keywords?");
+};
+
+}  // namespace lexer
+
+#endif
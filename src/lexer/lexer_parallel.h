@@ -0,0 +1,142 @@
+#ifndef KOLIBRI_SRC_LEXER_PARALLEL_H_
+#define KOLIBRI_SRC_LEXER_PARALLEL_H_
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace lexer {
+
+// Lexes a large buffer on several threads. The buffer is split into chunks and every chunk is
+// lexed speculatively as if a token started at its first byte, i.e. as if the boundary was not
+// inside a comment or another token. The chunks are then merged in order:
+//
+// Lexing is a deterministic function of the position Match() is called at. So as soon as the
+// exact token stream reaches a position at which the speculative lexing of a chunk called
+// Match() too, the rest of that chunk is identical and taken over. Up to this point the tokens
+// are lexed again. A chunk whose start state was wrong, e.g. because the boundary was inside a
+// comment, is therefore re-lexed only until both streams meet again.
+//
+// The result is identical to the tokens of lexer::Lexer between begin() and end().
+template <typename Rules>
+class ParallelLexer {
+ public:
+  using value_type = typename Rules::value_type;
+
+  static constexpr size_t kDefaultMinChunkSize = size_t{1} << 16;
+
+  explicit ParallelLexer(const char* begin, size_t len, unsigned num_threads = std::thread::hardware_concurrency(),
+                         size_t min_chunk_size = kDefaultMinChunkSize)
+      : begin_(begin), end_(begin + len), num_threads_(std::max(num_threads, 1u)), min_chunk_size_(std::max<size_t>(min_chunk_size, 1)), relexed_tokens_(0) {}
+
+  ParallelLexer(ParallelLexer const&) = delete;
+  ParallelLexer& operator=(ParallelLexer const&) = delete;
+
+  std::vector<value_type> Tokenize() {
+    eof_token_ = Rules().Match(end_, end_);
+    relexed_tokens_ = 0;
+
+    std::vector<const char*> bounds = SplitIntoChunks();
+    size_t num_chunks = bounds.size() - 1;
+    std::vector<Chunk> chunks(num_chunks);
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < num_chunks; ++i) {
+      threads.emplace_back([this, &chunks, &bounds, i]() { LexChunk(bounds[i], bounds[i + 1], chunks[i]); });
+    }
+    LexChunk(bounds[0], bounds[1], chunks[0]);  // the first chunk is exact
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    return Merge(bounds, chunks);
+  }
+
+  // Number of tokens which had to be lexed again while merging the last result.
+  size_t GetRelexedTokens() const { return relexed_tokens_; }
+
+ private:
+  struct Chunk {
+    std::vector<value_type> tokens;
+    std::vector<const char*> starts;  // position Match() was called at for each token
+    const char* exit;                 // first position Match() was called at behind the chunk
+  };
+
+  // Chunks end behind a newline if possible, which is a good guess for a token start.
+  std::vector<const char*> SplitIntoChunks() const {
+    size_t len = static_cast<size_t>(end_ - begin_);
+    size_t num_chunks = std::max<size_t>(1, std::min<size_t>(num_threads_, len / min_chunk_size_));
+    std::vector<const char*> bounds;
+    bounds.push_back(begin_);
+    for (size_t i = 1; i < num_chunks; ++i) {
+      const char* nominal = begin_ + len / num_chunks * i;
+      const char* next_nominal = begin_ + len / num_chunks * (i + 1);
+      const char* newline = std::find(nominal, next_nominal, '\n');
+      bounds.push_back(newline == next_nominal ? nominal : newline + 1);
+    }
+    bounds.push_back(end_);
+    return bounds;
+  }
+
+  bool IsEndOfFile(const value_type& token, const char* position) const { return (position == end_) && (token == eof_token_); }
+
+  void LexChunk(const char* pos, const char* limit, Chunk& chunk) const {
+    Rules rules;
+    while (pos < limit) {
+      value_type token = rules.Match(pos, end_);
+      const char* next = rules.GetPosition();
+      if (IsEndOfFile(token, next)) {
+        pos = end_;
+        break;
+      }
+      chunk.starts.push_back(pos);
+      chunk.tokens.push_back(token);
+      pos = next;
+    }
+    chunk.exit = pos;
+  }
+
+  std::vector<value_type> Merge(const std::vector<const char*>& bounds, std::vector<Chunk>& chunks) {
+    std::vector<value_type> result = std::move(chunks[0].tokens);
+    const char* pos = chunks[0].exit;
+
+    Rules rules;
+    for (size_t i = 1; (i < chunks.size()) && (pos != end_); ++i) {
+      Chunk& chunk = chunks[i];
+      while ((pos < bounds[i + 1]) && (pos != end_)) {
+        auto found = std::lower_bound(chunk.starts.begin(), chunk.starts.end(), pos);
+        if ((found != chunk.starts.end()) && (*found == pos)) {
+          // both streams meet, the remaining tokens of the chunk are exact
+          auto first = chunk.tokens.begin() + (found - chunk.starts.begin());
+          result.insert(result.end(), first, chunk.tokens.end());
+          pos = chunk.exit;
+          break;
+        }
+
+        value_type token = rules.Match(pos, end_);
+        const char* next = rules.GetPosition();
+        if (IsEndOfFile(token, next)) {
+          pos = end_;
+          break;
+        }
+        result.push_back(token);
+        relexed_tokens_++;
+        pos = next;
+      }
+    }
+    return result;
+  }
+
+  const char* begin_;
+  const char* end_;
+  unsigned num_threads_;
+  size_t min_chunk_size_;
+  size_t relexed_tokens_;
+  value_type eof_token_;
+};
+
+}  // namespace lexer
+
+#endif
@@ -1,60 +1,40 @@
 #ifndef KOLIBRI_SRC_LEXER_PREDICATES_H_
 #define KOLIBRI_SRC_LEXER_PREDICATES_H_
 
+#include "lexer/lexer_char_class.h"
+#include "lexer/lexer_char_set.h"
+
 namespace lexer {
 
 template <char Ch>
 struct IsChar {
-  bool operator()(char ch) { return (ch == Ch); }
+  constexpr bool operator()(char ch) const { return (ch == Ch); }
 };
 
-struct IsDigit {
-  bool operator()(char ch) { return (('0' <= ch) && (ch <= '9')); }
-};
+struct IsDigit : IsCharClass<kCharClassDigit> {};
 
-struct IsLowerCaseLetter {
-  bool operator()(char ch) { return (('a' <= ch) && (ch <= 'z')); }
-};
+struct IsLowerCaseLetter : IsCharClass<kCharClassLowerCaseLetter> {};
 
-struct IsUpperCaseLetter {
-  bool operator()(char ch) { return (('A' <= ch) && (ch <= 'Z')); }
-};
+struct IsUpperCaseLetter : IsCharClass<kCharClassUpperCaseLetter> {};
 
-struct IsLetter {
-  bool operator()(char ch) {
-    IsLowerCaseLetter is_alpha_lowercase;
-    if (is_alpha_lowercase(ch)) {
-      return true;
-    }
-    IsUpperCaseLetter is_alpha_uppercase;
-    return (is_alpha_uppercase(ch));
-  }
-};
+struct IsLetter : IsCharClass<kCharClassLetter> {};
 
-struct IsLetterOrDigit {
-  bool operator()(char ch) {
-    IsLetter is_alpha;
-    if (is_alpha(ch)) {
-      return true;
-    }
-    IsDigit is_digit;
-    return (is_digit(ch));
-  }
-};
+struct IsLetterOrDigit : IsCharClass<kCharClassLetterOrDigit> {};
 
+// Answered by a single table lookup if all predicates are constexpr. Otherwise the predicates are
+// called one after another.
 template <typename... TPredicates>
 struct PredicateOr {
-  bool operator()(char ch) { return Recurse<TPredicates...>(ch); }
-
-  template <typename T1>
-  bool Recurse(char ch) {
-    T1 t1;
-    return t1(ch);
-  }
-  template <typename T1, typename T2, typename... UPredicates>
-  bool Recurse(char ch) {
-    T1 t1;
-    return t1(ch) || Recurse<T2, UPredicates...>(ch);
+  struct Evaluate {
+    constexpr bool operator()(char ch) const { return (TPredicates{}(ch) || ...); }
+  };
+
+  constexpr bool operator()(char ch) const {
+    if constexpr (is_constexpr_predicate<Evaluate>::value) {
+      return PredicateTable<Evaluate>{}(ch);
+    } else {
+      return Evaluate{}(ch);
+    }
   }
 };
 
@@ -1,17 +1,24 @@
 #ifndef KOLIBRI_SRC_LEXER_RULES_H_
 #define KOLIBRI_SRC_LEXER_RULES_H_
 
+#include <stdint.h>
+
+#include <array>
 #include <type_traits>
 
+#include "lexer/lexer_char_set.h"
+#include "lexer/lexer_predicates.h"
+#include "lexer/lexer_simd.h"
 #include "lexer/lexer_traits.h"
 #include "lexer/lexer_transforms.h"
+#include "lexer/lexer_utf8.h"
 
 namespace lexer {
 
 template <typename TStringProvider, bool CaseInsensitive = false>
 class MatcherString {
  public:
-  const char* Parse(const char* begin, const char* end) {
+  constexpr const char* Parse(const char* begin, const char* end) {
     const char* cmp = TStringProvider::GetString();
     const char* pos = begin;
     for (; pos < end; pos++) {
@@ -36,14 +43,14 @@ class MatcherString {
 template <typename TStringProvider>
 class MatcherString<TStringProvider, true> {
  public:
-  const char* Parse(const char* begin, const char* end) {
+  constexpr const char* Parse(const char* begin, const char* end) {
     const char* cmp = TStringProvider::GetString();
     const char* pos = begin;
     for (; pos < end; pos++) {
       if (*cmp == '\0') {
         break;
       }
-      ToLowerCase to_lower_case;
+      ToLowerCase to_lower_case{};
       if (to_lower_case(*cmp) != to_lower_case(*pos)) {
         return begin;
       }
@@ -61,8 +68,8 @@ class MatcherString<TStringProvider, true> {
 template <typename TPredicate>
 class MatcherPredicate {
  public:
-  const char* Parse(const char* begin, const char* end) {
-    TPredicate pred;
+  constexpr const char* Parse(const char* begin, const char* end) {
+    TPredicate pred{};
     if (begin == end) {
       return begin;
     }
@@ -76,8 +83,8 @@ class MatcherPredicate {
 template <typename TPredicate>
 class MatcherRangeByPredicate {
  public:
-  const char* Parse(const char* begin, const char* end) {
-    TPredicate pred;
+  constexpr const char* Parse(const char* begin, const char* end) {
+    TPredicate pred{};
     const char* pos = begin;
     for (; pos < end; pos++) {
       if (!pred(*pos)) {
@@ -88,18 +95,100 @@ class MatcherRangeByPredicate {
   }
 };
 
+// Drop-in replacement of MatcherRangeByPredicate for constexpr predicates. The bytes accepted by
+// the predicate are turned into intervals at compile time and the input is classified 16 or 32
+// bytes per step.
+template <typename TPredicate>
+class MatcherSimdRangeByPredicate {
+ public:
+  constexpr const char* Parse(const char* begin, const char* end) {
+    if (simd::IsConstantEvaluated()) {
+      return simd::ScanRangeScalar<TPredicate>(begin, end);
+    }
+    return simd::ScanRange<TPredicate>(begin, end);
+  }
+};
+
+// Runs of a single char, e.g. indentation, are skipped by the SIMD scanner.
+template <char C>
+class MatcherRangeByPredicate<IsChar<C>> {
+ public:
+  constexpr const char* Parse(const char* begin, const char* end) {
+    if (simd::IsConstantEvaluated()) {
+      return simd::ScanByteScalar<false>(begin, end, C);
+    }
+    return simd::SkipByte(begin, end, C);
+  }
+};
+
+// Matches one char of the start predicate followed by any number of chars of the second one,
+// e.g. an identifier. The range is consumed in one pass by the SIMD range scanner, so the second
+// predicate has to be constexpr.
+template <typename TStartPredicate, typename TPredicate>
+class MatcherIdentifier {
+ public:
+  constexpr const char* Parse(const char* begin, const char* end) {
+    TStartPredicate start_pred{};
+    if ((begin == end) || !start_pred(*begin)) {
+      return begin;
+    }
+    if (simd::IsConstantEvaluated()) {
+      return simd::ScanRangeScalar<TPredicate>(begin + 1, end);
+    }
+    return simd::ScanRange<TPredicate>(begin + 1, end);
+  }
+};
+
+// UTF-8 version of MatcherIdentifier. ASCII chars are matched by the predicates, the ASCII runs are
+// consumed by the SIMD range scanner. Multibyte chars are decoded and matched by the Unicode
+// identifier classes of lexer_utf8.h. The predicates must not accept bytes above 0x7F.
+template <typename TStartPredicate, typename TPredicate>
+class MatcherUtf8Identifier {
+ public:
+  constexpr const char* Parse(const char* begin, const char* end) {
+    if (begin == end) {
+      return begin;
+    }
+    const char* pos = begin;
+    if (utf8::IsAscii(*begin)) {
+      TStartPredicate start_pred{};
+      if (!start_pred(*begin)) {
+        return begin;
+      }
+      pos++;
+    } else {
+      pos += utf8::IdentifierCharLength<true>(begin, end);
+      if (pos == begin) {
+        return begin;
+      }
+    }
+
+    while (true) {
+      pos = simd::IsConstantEvaluated() ? simd::ScanRangeScalar<TPredicate>(pos, end) : simd::ScanRange<TPredicate>(pos, end);
+      if ((pos == end) || utf8::IsAscii(*pos)) {
+        return pos;
+      }
+      unsigned length = utf8::IdentifierCharLength<false>(pos, end);
+      if (length == 0) {
+        return pos;
+      }
+      pos += length;
+    }
+  }
+};
+
 template <typename TStartMatcher, typename TStopMatcher>
 class MatcherRangeByStartStopDelimiter {
  public:
-  const char* Parse(const char* begin, const char* end) {
-    TStartMatcher start_matcher;
+  constexpr const char* Parse(const char* begin, const char* end) {
+    TStartMatcher start_matcher{};
     auto it_ = start_matcher.Parse(begin, end);
     if (it_ == begin) {
       return begin;
     }
 
     const char* pos = it_;
-    TStopMatcher stop_matcher;
+    TStopMatcher stop_matcher{};
     for (; pos < end; pos++) {
       it_ = stop_matcher.Parse(pos, end);
       if (it_ != pos) {
@@ -110,15 +199,46 @@ class MatcherRangeByStartStopDelimiter {
   }
 };
 
+// A delimited range with a fixed stop string, e.g. a comment. Candidates for the stop string are
+// searched by the SIMD scanner for its first char.
+template <typename TStartMatcher, typename TStringProvider>
+class MatcherRangeByStartStopDelimiter<TStartMatcher, MatcherString<TStringProvider>> {
+ public:
+  constexpr const char* Parse(const char* begin, const char* end) {
+    TStartMatcher start_matcher{};
+    auto it_ = start_matcher.Parse(begin, end);
+    if (it_ == begin) {
+      return begin;
+    }
+
+    const char first = TStringProvider::GetString()[0];
+    if (first == '\0') {
+      return begin;  // an empty stop string never matches
+    }
+
+    MatcherString<TStringProvider> stop_matcher{};
+    for (const char* pos = it_;; pos++) {
+      pos = simd::IsConstantEvaluated() ? simd::ScanByteScalar<true>(pos, end, first) : simd::FindByte(pos, end, first);
+      if (pos == end) {
+        return begin;
+      }
+      it_ = stop_matcher.Parse(pos, end);
+      if (it_ != pos) {
+        return it_;
+      }
+    }
+  }
+};
+
 template <typename... TMatchers>
 class MatcherSequence {
  public:
-  const char* Parse(const char* begin, const char* end) { return ParseRecursive<TMatchers...>(begin, begin, end); }
+  constexpr const char* Parse(const char* begin, const char* end) { return ParseRecursive<TMatchers...>(begin, begin, end); }
 
  private:
   template <typename T1>
-  const char* ParseRecursive(const char* begin, const char* it, const char* end) {
-    T1 matcher;
+  constexpr const char* ParseRecursive(const char* begin, const char* it, const char* end) {
+    T1 matcher{};
     auto* new_it = matcher.Parse(it, end);
     if (new_it == it) {
       return begin;
@@ -127,8 +247,8 @@ class MatcherSequence {
   }
 
   template <typename T1, typename T2, typename... UMatchers>
-  const char* ParseRecursive(const char* begin, const char* it, const char* end) {
-    T1 matcher;
+  constexpr const char* ParseRecursive(const char* begin, const char* it, const char* end) {
+    T1 matcher{};
     auto* new_it = matcher.Parse(it, end);
     if (new_it == it) {
       return begin;
@@ -140,20 +260,125 @@ class MatcherSequence {
   }
 };
 
+// The bytes accepted by a predicate. Predicates which can't be evaluated at compile time may
+// accept any byte.
+template <typename TPredicate>
+constexpr CharSet PredicateFirstSet() {
+  if constexpr (is_constexpr_predicate<TPredicate>::value) {
+    return MakeCharSet<TPredicate>();
+  } else {
+    return CharSet::All();
+  }
+}
+
+// The set of bytes a matcher can start a match with. Matchers which are not known here may start
+// with any byte.
+template <typename TMatcher>
+struct MatcherFirstSet {
+  static constexpr CharSet Get() { return CharSet::All(); }
+};
+
+template <typename TPredicate>
+struct MatcherFirstSet<MatcherPredicate<TPredicate>> {
+  static constexpr CharSet Get() { return PredicateFirstSet<TPredicate>(); }
+};
+
+template <typename TPredicate>
+struct MatcherFirstSet<MatcherRangeByPredicate<TPredicate>> {
+  static constexpr CharSet Get() { return PredicateFirstSet<TPredicate>(); }
+};
+
+template <typename TPredicate>
+struct MatcherFirstSet<MatcherSimdRangeByPredicate<TPredicate>> {
+  static constexpr CharSet Get() { return PredicateFirstSet<TPredicate>(); }
+};
+
+template <typename TStartPredicate, typename TPredicate>
+struct MatcherFirstSet<MatcherIdentifier<TStartPredicate, TPredicate>> {
+  static constexpr CharSet Get() { return PredicateFirstSet<TStartPredicate>(); }
+};
+
+// the start predicate or a lead byte of a multibyte sequence
+template <typename TStartPredicate, typename TPredicate>
+struct MatcherFirstSet<MatcherUtf8Identifier<TStartPredicate, TPredicate>> {
+  static constexpr CharSet Get() {
+    CharSet set = PredicateFirstSet<TStartPredicate>();
+    for (unsigned ch = 0xC2; ch <= 0xF4; ++ch) {
+      set.Insert(static_cast<unsigned char>(ch));
+    }
+    return set;
+  }
+};
+
+template <typename TStringProvider, bool CaseInsensitive>
+struct MatcherFirstSet<MatcherString<TStringProvider, CaseInsensitive>> {
+  static constexpr CharSet Get() {
+    CharSet set;
+    char first = TStringProvider::GetString()[0];
+    if (first == '\0') {
+      return set;  // an empty string never matches
+    }
+    ToLowerCase to_lower_case{};
+    for (unsigned ch = 0; ch < 256; ++ch) {
+      if (CaseInsensitive ? (to_lower_case(static_cast<char>(ch)) == to_lower_case(first)) : (static_cast<char>(ch) == first)) {
+        set.Insert(static_cast<unsigned char>(ch));
+      }
+    }
+    return set;
+  }
+};
+
+template <typename TStartMatcher, typename TStopMatcher>
+struct MatcherFirstSet<MatcherRangeByStartStopDelimiter<TStartMatcher, TStopMatcher>> {
+  static constexpr CharSet Get() { return MatcherFirstSet<TStartMatcher>::Get(); }
+};
+
+// every matcher of a sequence has to consume at least one char, so only the first one counts
+template <typename TMatcher, typename... TMatchers>
+struct MatcherFirstSet<MatcherSequence<TMatcher, TMatchers...>> {
+  static constexpr CharSet Get() { return MatcherFirstSet<TMatcher>::Get(); }
+};
+
+template <typename TRule, typename = void>
+struct RuleFirstSet {
+  static constexpr CharSet Get() { return CharSet::All(); }
+};
+
+template <typename TRule>
+struct RuleFirstSet<TRule, std::void_t<typename TRule::matcher_type>> {
+  static constexpr CharSet Get() { return MatcherFirstSet<typename TRule::matcher_type>::Get(); }
+};
+
+// Bit i of the mask of byte ch is set when the i-th rule can start with ch.
+template <typename... TRules>
+constexpr std::array<uint64_t, 256> MakeCandidateMasks() {
+  const CharSet first_sets[sizeof...(TRules) + 1] = {RuleFirstSet<TRules>::Get()...};
+  std::array<uint64_t, 256> masks{};
+  for (unsigned ch = 0; ch < 256; ++ch) {
+    for (unsigned i = 0; i < sizeof...(TRules); ++i) {
+      if (first_sets[i].Contains(static_cast<unsigned char>(ch))) {
+        masks[ch] |= uint64_t{1} << i;
+      }
+    }
+  }
+  return masks;
+}
+
 template <typename TProduction, typename TMatcher>
 class Rule {
  public:
   using value_type = typename TProduction::value_type;
   using production_type = TProduction;
+  using matcher_type = TMatcher;
 
-  const char* Match(const char* begin, const char* end) {
-    TMatcher matcher;
+  constexpr const char* Match(const char* begin, const char* end) {
+    TMatcher matcher{};
     auto* it = matcher.Parse(begin, end);
     return it;
   }
 
-  value_type Create(const char* begin, const char* end) {
-    production_type factory;
+  constexpr value_type Create(const char* begin, const char* end) {
+    production_type factory{};
     return factory.Create(begin, end);
   }
 };
@@ -163,60 +388,100 @@ class LexerRules {
  public:
   using value_type = typename TProductionUNK::value_type;  // Use value type of first factory
 
-  value_type Match(const char* begin, const char* end) {
-    // reached end
-    if (begin == end) {
-      it_ = end;
-      return TProductionEOF().Create(begin, end);
-    }
+  constexpr value_type Match(const char* begin, const char* end) {
+    // skipped tokens are consumed in a loop
+    while (true) {
+      // reached end
+      if (begin == end) {
+        it_ = end;
+        return TProductionEOF().Create(begin, end);
+      }
 
-    return MatchRecursive<TRules...>(begin, end);
+      // only the rules which can start with the current char are tried
+      unsigned rule = MatchRecursive<0, TRules...>(begin, end, kCandidates[static_cast<unsigned char>(*begin)]);
+      if (rule == kNoRule) {
+        return CreateUnknown(begin, end);
+      }
+      if (!kIsSkip[rule]) {
+        return CreateRecursive<0, TRules...>(rule, begin, it_);
+      }
+      begin = it_;
+    }
   };
 
-  const char* GetPosition() { return it_; }
+  constexpr const char* GetPosition() const { return it_; }
 
  private:
-  const char* it_;
+  static_assert(sizeof...(TRules) <= 64, "LexerRules: the candidate mask supports up to 64 rules");
 
-  template <bool Cond>
-  struct SelectCreateOrRedirect {
-    template <typename TLexer, typename TRule>
-    static constexpr value_type impl(TLexer& lexer, TRule& rule, const char* token_begin, const char* token_end, const char* end) noexcept {
-      return rule.Create(token_begin, token_end);
-    }
-  };
+  static constexpr std::array<uint64_t, 256> kCandidates = MakeCandidateMasks<TRules...>();
 
-  template <>
-  struct SelectCreateOrRedirect<true> {
-    template <typename TLexer, typename TRule>
-    static constexpr value_type impl(TLexer& lexer, TRule& rule, const char* token_begin, const char* token_end, const char* end) noexcept {
-      return lexer.Match(token_end, end);
-    }
-  };
+  using unknown_traits = unknown_production_traits<TProductionUNK>;
 
-  template <typename T1>
-  value_type MatchRecursive(const char* begin, const char* end) {
-    T1 t1;
-    auto it = t1.Match(begin, end);
-    if (it != begin) {
-      it_ = it;
-      return SelectCreateOrRedirect<is_skip_production_class<typename T1::production_type>::value>::impl(*this, t1, begin, it_, end);
-    }
-    it_ = begin + 1;
+  const char* it_ = nullptr;
+  size_t errors_ = 0;  // unknown tokens so far, only counted in the recovery mode
+
+  // One byte which no rule matches. See CoalesceUnknown for the recovery mode.
+  constexpr value_type CreateUnknown(const char* begin, const char* end) {
+    const char* unknown_end = begin + 1;
+    if constexpr (unknown_traits::kCoalesce) {
+      if ((unknown_traits::kErrorBudget != 0) && (errors_ == unknown_traits::kErrorBudget)) {
+        it_ = end;
+        return TProductionEOF().Create(end, end);
+      }
+      errors_++;
+
+      while ((unknown_end != end) && (MatchRecursive<0, TRules...>(unknown_end, end, kCandidates[static_cast<unsigned char>(*unknown_end)]) == kNoRule)) {
+        ++unknown_end;
+      }
+    }
+    it_ = unknown_end;
     return TProductionUNK().Create(begin, it_);
   }
 
-  template <typename T1, typename T2, typename... URules>
-  value_type MatchRecursive(const char* begin, const char* end) {
-    T1 t1;
-    auto it = t1.Match(begin, end);
+  static constexpr unsigned kNoRule = sizeof...(TRules);
+  static constexpr bool kIsSkip[sizeof...(TRules) + 1] = {is_skip_production_class<typename TRules::production_type>::value...};
 
-    if (it != begin) {
-      it_ = it;
-      return SelectCreateOrRedirect<is_skip_production_class<typename T1::production_type>::value>::impl(*this, t1, begin, it_, end);
+  // Returns the index of the first rule which matches and stores the end of the match.
+  template <unsigned Index>
+  constexpr unsigned MatchRecursive(const char* /*begin*/, const char* /*end*/, uint64_t /*candidates*/) {
+    return kNoRule;
+  }
+
+  template <unsigned Index, typename T1, typename... URules>
+  constexpr unsigned MatchRecursive(const char* begin, const char* end, uint64_t candidates) {
+    if ((candidates >> Index) == 0) {
+      // none of the remaining rules can match
+      return kNoRule;
+    }
+
+    if ((candidates >> Index) & 1) {
+      T1 t1{};
+      auto it = t1.Match(begin, end);
+
+      if (it != begin) {
+        it_ = it;
+        return Index;
+      }
     }
 
-    return MatchRecursive<T2, URules...>(begin, end);
+    return MatchRecursive<Index + 1, URules...>(begin, end, candidates);
+  }
+
+  template <unsigned Index>
+  constexpr value_type CreateRecursive(unsigned /*rule*/, const char* begin, const char* end) {
+    return TProductionUNK().Create(begin, end);  // not reachable
+  }
+
+  template <unsigned Index, typename T1, typename... URules>
+  constexpr value_type CreateRecursive(unsigned rule, const char* begin, const char* end) {
+    if constexpr (!is_skip_production_class<typename T1::production_type>::value) {
+      if (rule == Index) {
+        T1 t1{};
+        return t1.Create(begin, end);
+      }
+    }
+    return CreateRecursive<Index + 1, URules...>(rule, begin, end);
   }
 };
 
@@ -236,6 +501,15 @@ class LexerRulesBase {
   template <typename TPredicate>
   using MatcherRangeByPredicate = lexer::MatcherRangeByPredicate<TPredicate>;
 
+  template <typename TPredicate>
+  using MatcherSimdRangeByPredicate = lexer::MatcherSimdRangeByPredicate<TPredicate>;
+
+  template <typename TStartPredicate, typename TPredicate>
+  using MatcherIdentifier = lexer::MatcherIdentifier<TStartPredicate, TPredicate>;
+
+  template <typename TStartPredicate, typename TPredicate>
+  using MatcherUtf8Identifier = lexer::MatcherUtf8Identifier<TStartPredicate, TPredicate>;
+
   template <typename... TMatchers>
   using MatcherSequence = lexer::MatcherSequence<TMatchers...>;
 };
@@ -0,0 +1,264 @@
+#ifndef KOLIBRI_SRC_LEXER_SIMD_H_
+#define KOLIBRI_SRC_LEXER_SIMD_H_
+
+#include "lexer/lexer_char_set.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define KOLIBRI_LEXER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(KOLIBRI_LEXER_SSE2) && defined(__GNUC__)
+#define KOLIBRI_LEXER_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace lexer {
+namespace simd {
+
+// Byte scanners used by the hot matchers. The widest implementation the cpu supports is selected
+// once at runtime. All of them return the first position in [begin, end) whose byte compares to ch
+// as requested (Equal == true: first byte equal to ch, Equal == false: first byte not equal to ch)
+// or end.
+
+using ScanByteFunction = const char* (*)(const char*, const char*, char);
+
+// True while the compiler evaluates a constant expression. The vector scanners can't run there,
+// so the constexpr matchers fall back to the scalar ones.
+constexpr bool IsConstantEvaluated() {
+#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && (_MSC_VER >= 1928))
+  return __builtin_is_constant_evaluated();
+#else
+  return false;
+#endif
+}
+
+inline unsigned CountTrailingZeros(unsigned mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long index;
+  _BitScanForward(&index, mask);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+template <bool Equal>
+constexpr const char* ScanByteScalar(const char* begin, const char* end, char ch) {
+  for (; begin < end; ++begin) {
+    if ((*begin == ch) == Equal) {
+      break;
+    }
+  }
+  return begin;
+}
+
+#if defined(KOLIBRI_LEXER_SSE2)
+template <bool Equal>
+inline const char* ScanByteSse2(const char* begin, const char* end, char ch) {
+  const __m128i needle = _mm_set1_epi8(ch);
+  for (; end - begin >= 16; begin += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+    if (!Equal) {
+      mask = ~mask & 0xFFFFu;
+    }
+    if (mask != 0) {
+      return begin + CountTrailingZeros(mask);
+    }
+  }
+  return ScanByteScalar<Equal>(begin, end, ch);
+}
+#endif
+
+#if defined(KOLIBRI_LEXER_AVX2)
+template <bool Equal>
+__attribute__((target("avx2"))) inline const char* ScanByteAvx2(const char* begin, const char* end, char ch) {
+  const __m256i needle = _mm256_set1_epi8(ch);
+  for (; end - begin >= 32; begin += 32) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+    if (!Equal) {
+      mask = ~mask;
+    }
+    if (mask != 0) {
+      return begin + CountTrailingZeros(mask);
+    }
+  }
+  return ScanByteSse2<Equal>(begin, end, ch);
+}
+#endif
+
+template <bool Equal>
+inline ScanByteFunction SelectScanByte() {
+#if defined(KOLIBRI_LEXER_AVX2)
+  if (__builtin_cpu_supports("avx2")) {
+    return &ScanByteAvx2<Equal>;
+  }
+#endif
+#if defined(KOLIBRI_LEXER_SSE2)
+  return &ScanByteSse2<Equal>;
+#else
+  return &ScanByteScalar<Equal>;
+#endif
+}
+
+template <bool Equal>
+inline const char* ScanByte(const char* begin, const char* end, char ch) {
+  // most runs are short and are not worth the indirect call
+  const char* head_end = (end - begin) < 16 ? end : begin + 16;
+  const char* pos = ScanByteScalar<Equal>(begin, head_end, ch);
+  if (pos != head_end || pos == end) {
+    return pos;
+  }
+  static const ScanByteFunction scan = SelectScanByte<Equal>();
+  return scan(pos, end, ch);
+}
+
+// Returns the first position of ch or end.
+inline const char* FindByte(const char* begin, const char* end, char ch) { return ScanByte<true>(begin, end, ch); }
+
+// Returns the first position which is not ch or end.
+inline const char* SkipByte(const char* begin, const char* end, char ch) { return ScanByte<false>(begin, end, ch); }
+
+// ------------------------------------------------------------------------------------------------
+// RANGE SCANNERS
+// ------------------------------------------------------------------------------------------------
+
+// The bytes accepted by a constexpr predicate as a list of closed intervals, e.g. IsLetterOrDigit
+// is [0-9], [A-Z], [a-z]. A vector of bytes is classified with one compare per interval.
+constexpr unsigned kMaxByteRanges = 8;
+
+struct ByteRanges {
+  constexpr ByteRanges() : size(0), lo(), hi(), overflow(false) {}
+
+  unsigned size;
+  unsigned char lo[kMaxByteRanges];
+  unsigned char hi[kMaxByteRanges];
+  bool overflow;  // too many intervals, the scalar scanner is used
+};
+
+template <typename TPredicate>
+constexpr ByteRanges MakeByteRanges() {
+  CharSet set = MakeCharSet<TPredicate>();
+  ByteRanges ranges;
+  for (unsigned ch = 0; ch < 256; ++ch) {
+    if (!set.Contains(static_cast<unsigned char>(ch))) {
+      continue;
+    }
+    if ((ch > 0) && set.Contains(static_cast<unsigned char>(ch - 1))) {
+      ranges.hi[ranges.size - 1] = static_cast<unsigned char>(ch);
+      continue;
+    }
+    if (ranges.size == kMaxByteRanges) {
+      ranges.overflow = true;
+      return ranges;
+    }
+    ranges.lo[ranges.size] = static_cast<unsigned char>(ch);
+    ranges.hi[ranges.size] = static_cast<unsigned char>(ch);
+    ranges.size++;
+  }
+  return ranges;
+}
+
+template <typename TPredicate>
+struct ByteRangesOf {
+  static constexpr ByteRanges kRanges = MakeByteRanges<TPredicate>();
+};
+
+// All range scanners return the first position in [begin, end) which is not accepted by the
+// predicate or end.
+template <typename TPredicate>
+constexpr const char* ScanRangeScalar(const char* begin, const char* end) {
+  TPredicate pred{};
+  for (; begin < end; ++begin) {
+    if (!pred(*begin)) {
+      break;
+    }
+  }
+  return begin;
+}
+
+#if defined(KOLIBRI_LEXER_SSE2)
+template <typename TPredicate>
+inline const char* ScanRangeSse2(const char* begin, const char* end) {
+  constexpr const ByteRanges& ranges = ByteRangesOf<TPredicate>::kRanges;
+  for (; end - begin >= 16; begin += 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    __m128i accepted = _mm_setzero_si128();
+    for (unsigned i = 0; i < ranges.size; ++i) {
+      // lo <= ch <= hi  <=>  (ch - lo) <= (hi - lo) as unsigned bytes
+      __m128i shifted = _mm_sub_epi8(chunk, _mm_set1_epi8(static_cast<char>(ranges.lo[i])));
+      __m128i width = _mm_set1_epi8(static_cast<char>(ranges.hi[i] - ranges.lo[i]));
+      accepted = _mm_or_si128(accepted, _mm_cmpeq_epi8(_mm_min_epu8(shifted, width), shifted));
+    }
+    unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(accepted)) & 0xFFFFu;
+    if (mask != 0) {
+      return begin + CountTrailingZeros(mask);
+    }
+  }
+  return ScanRangeScalar<TPredicate>(begin, end);
+}
+#endif
+
+#if defined(KOLIBRI_LEXER_AVX2)
+template <typename TPredicate>
+__attribute__((target("avx2"))) inline const char* ScanRangeAvx2(const char* begin, const char* end) {
+  constexpr const ByteRanges& ranges = ByteRangesOf<TPredicate>::kRanges;
+  for (; end - begin >= 32; begin += 32) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    __m256i accepted = _mm256_setzero_si256();
+    for (unsigned i = 0; i < ranges.size; ++i) {
+      __m256i shifted = _mm256_sub_epi8(chunk, _mm256_set1_epi8(static_cast<char>(ranges.lo[i])));
+      __m256i width = _mm256_set1_epi8(static_cast<char>(ranges.hi[i] - ranges.lo[i]));
+      accepted = _mm256_or_si256(accepted, _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, width), shifted));
+    }
+    unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(accepted));
+    if (mask != 0) {
+      return begin + CountTrailingZeros(mask);
+    }
+  }
+  return ScanRangeSse2<TPredicate>(begin, end);
+}
+#endif
+
+using ScanRangeFunction = const char* (*)(const char*, const char*);
+
+template <typename TPredicate>
+inline ScanRangeFunction SelectScanRange() {
+  if (ByteRangesOf<TPredicate>::kRanges.overflow) {
+    return &ScanRangeScalar<TPredicate>;
+  }
+#if defined(KOLIBRI_LEXER_AVX2)
+  if (__builtin_cpu_supports("avx2")) {
+    return &ScanRangeAvx2<TPredicate>;
+  }
+#endif
+#if defined(KOLIBRI_LEXER_SSE2)
+  return &ScanRangeSse2<TPredicate>;
+#else
+  return &ScanRangeScalar<TPredicate>;
+#endif
+}
+
+// Returns the first position which is not accepted by the constexpr predicate or end.
+template <typename TPredicate>
+inline const char* ScanRange(const char* begin, const char* end) {
+  // most identifiers and numbers are short and are not worth the indirect call
+  const char* head_end = (end - begin) < 16 ? end : begin + 16;
+  const char* pos = ScanRangeScalar<TPredicate>(begin, head_end);
+  if (pos != head_end || pos == end) {
+    return pos;
+  }
+  static const ScanRangeFunction scan = SelectScanRange<TPredicate>();
+  return scan(pos, end);
+}
+
+}  // namespace simd
+}  // namespace lexer
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef KOLIBRI_SRC_LEXER_STREAM_H_
+#define KOLIBRI_SRC_LEXER_STREAM_H_
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "lexer/lexer_dfa_rules.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <errno.h>
+#include <unistd.h>
+#endif
+
+namespace lexer {
+
+// A token of the StreamLexer. The token points into a chunk of the input which is kept alive by
+// the token; the chunk is released as soon as no token references it anymore.
+template <typename TToken>
+struct PinnedToken {
+  TToken token;
+  std::shared_ptr<const std::string> chunk;
+};
+
+// Lexes input which is read in chunks from a std::istream or a file descriptor, so the input
+// never has to be in memory as a whole. Tokens which span a chunk boundary, e.g. long comments
+// or identifiers, are handled by reading more input and lexing them again from their start.
+//
+// The memory is bounded by the chunk size and max_token_length. A match which gets longer than
+// max_token_length is continued on the following input without keeping it. Skipped input, e.g. a
+// long comment, is thrown away. A longer token is returned as one unknown token of its first
+// max_token_length bytes or more; lexing goes on behind the whole token.
+//
+// Rules have to report when a decision depended on the end of the given range and have to be
+// able to continue such a match, which DfaLexerRules does.
+template <typename Rules>
+class StreamLexer {
+ public:
+  using token_type = typename Rules::value_type;
+  using value_type = PinnedToken<token_type>;
+  using reader_type = std::function<size_t(char*, size_t)>;  // returns 0 at the end of the input
+
+  static constexpr size_t kDefaultChunkSize = size_t{1} << 16;
+  static constexpr size_t kDefaultMaxTokenLength = size_t{1} << 26;
+
+  explicit StreamLexer(reader_type reader, size_t chunk_size = kDefaultChunkSize, size_t max_token_length = kDefaultMaxTokenLength)
+      : reader_(std::move(reader)),
+        chunk_size_(std::max<size_t>(chunk_size, 1)),
+        max_token_length_(max_token_length),
+        chunk_(std::make_shared<std::string>()),
+        pos_(0),
+        eof_(false),
+        at_end_(false),
+        rules_() {}
+
+  explicit StreamLexer(std::istream& input, size_t chunk_size = kDefaultChunkSize, size_t max_token_length = kDefaultMaxTokenLength)
+      : StreamLexer(IStreamReader(input), chunk_size, max_token_length) {}
+
+#if defined(__unix__) || defined(__APPLE__)
+  explicit StreamLexer(int fd, size_t chunk_size = kDefaultChunkSize, size_t max_token_length = kDefaultMaxTokenLength)
+      : StreamLexer(FileDescriptorReader(fd), chunk_size, max_token_length) {}
+#endif
+
+  StreamLexer(StreamLexer const&) = delete;
+  StreamLexer& operator=(StreamLexer const&) = delete;
+
+  // Returns the next token. After the whole input is lexed the end of file token is returned.
+  value_type Next() {
+    while (true) {
+      const char* data = chunk_->data();
+      const char* begin = data + pos_;
+      const char* end = data + chunk_->size();
+      token_type token = rules_.Match(begin, end);
+
+      size_t pending = static_cast<size_t>(end - rules_.GetTokenBegin());
+      if (!rules_.HitEnd() || eof_) {
+        pos_ = static_cast<size_t>(rules_.GetPosition() - data);
+        at_end_ = eof_ && (rules_.GetTokenBegin() == end);
+        return {token, chunk_};
+      }
+
+      if (pending >= max_token_length_) {
+        const char* token_begin = rules_.GetTokenBegin();
+        auto kept = chunk_;
+        if (ContinueLongMatch()) {
+          continue;
+        }
+        return {rules_.CreateTooLong(token_begin, end), kept};
+      }
+
+      // the token may continue in the next chunk
+      Refill(static_cast<size_t>(rules_.GetTokenBegin() - data));
+    }
+  }
+
+  // True after the end of file token was returned
+  bool AtEnd() const { return at_end_; }
+
+ private:
+  static reader_type IStreamReader(std::istream& input) {
+    return [&input](char* buffer, size_t len) {
+      input.read(buffer, static_cast<std::streamsize>(len));
+      return static_cast<size_t>(input.gcount());
+    };
+  }
+
+#if defined(__unix__) || defined(__APPLE__)
+  static reader_type FileDescriptorReader(int fd) {
+    return [fd](char* buffer, size_t len) -> size_t {
+      while (true) {
+        ssize_t count = read(fd, buffer, len);
+        if (count >= 0) {
+          return static_cast<size_t>(count);
+        }
+        if (errno != EINTR) {
+          return 0;
+        }
+      }
+    };
+  }
+#endif
+
+  // Feeds new chunks to the rules until the match which got too long is decided. Only the chunk
+  // with the end of the match is kept. Returns true if the match was skipped input.
+  bool ContinueLongMatch() {
+    while (true) {
+      Refill(chunk_->size());
+      const char* data = chunk_->data();
+      DfaContinuation result = rules_.Continue(data, data + chunk_->size(), eof_);
+      if (result != DfaContinuation::kNeedsInput) {
+        pos_ = static_cast<size_t>(rules_.GetPosition() - data);
+        return result == DfaContinuation::kSkipped;
+      }
+    }
+  }
+
+  // Starts a new chunk with the unprocessed tail of the current one followed by new input. The
+  // current chunk is not modified because tokens may still point into it. The read size grows
+  // with the tail, so a long token is lexed again only a logarithmic number of times.
+  void Refill(size_t keep_from) {
+    size_t tail = chunk_->size() - keep_from;
+    size_t read_size = std::max(chunk_size_, tail);
+    auto next = std::make_shared<std::string>();
+    next->resize(tail + read_size);
+    std::copy(chunk_->data() + keep_from, chunk_->data() + chunk_->size(), &(*next)[0]);
+
+    size_t filled = 0;
+    while (filled < read_size) {
+      size_t count = reader_(&(*next)[tail + filled], read_size - filled);
+      if (count == 0) {
+        eof_ = true;
+        break;
+      }
+      filled += count;
+    }
+    next->resize(tail + filled);
+
+    chunk_ = std::move(next);
+    pos_ = 0;
+  }
+
+  reader_type reader_;
+  size_t chunk_size_;
+  size_t max_token_length_;
+  std::shared_ptr<std::string> chunk_;
+  size_t pos_;
+  bool eof_;
+  bool at_end_;
+  Rules rules_;
+};
+
+}  // namespace lexer
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef KOLIBRI_SRC_LEXER_TRAITS_H_
 #define KOLIBRI_SRC_LEXER_TRAITS_H_
 
+#include <stddef.h>
+
 #include <type_traits>
 
 namespace lexer {
@@ -14,6 +16,29 @@ template <class T>
 
 struct is_skip_production_class : std::integral_constant<bool, std::is_base_of<SkipProduction, T>::value> {};
 
+class CoalesceUnknownTag {};
+
+// Wraps the unknown production of a lexer to recover from garbage input. Consecutive bytes which
+// no rule matches become one unknown token instead of one token per byte. After ErrorBudget
+// unknown tokens the lexer stops with the end of file token. An ErrorBudget of 0 is unlimited.
+template <typename TProductionUNK, size_t ErrorBudget = 0>
+class CoalesceUnknown : public TProductionUNK, public CoalesceUnknownTag {
+ public:
+  static constexpr size_t kErrorBudget = ErrorBudget;
+};
+
+template <class T, bool = std::is_base_of<CoalesceUnknownTag, T>::value>
+struct unknown_production_traits {
+  static constexpr bool kCoalesce = false;
+  static constexpr size_t kErrorBudget = 0;
+};
+
+template <class T>
+struct unknown_production_traits<T, true> {
+  static constexpr bool kCoalesce = true;
+  static constexpr size_t kErrorBudget = T::kErrorBudget;
+};
+
 }  // namespace lexer
 
 #endif
\ No newline at end of file
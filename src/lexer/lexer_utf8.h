@@ -0,0 +1,226 @@
+#ifndef KOLIBRI_SRC_LEXER_UTF8_H_
+#define KOLIBRI_SRC_LEXER_UTF8_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lexer/lexer_simd.h"
+
+namespace lexer {
+namespace utf8 {
+
+// UTF-8 support of the lexer. All ASCII bytes stand for themselves in UTF-8 and never occur inside
+// a multibyte sequence, so the byte matchers work unchanged on UTF-8 input, e.g. a comment which
+// is skipped up to '}' may hold any UTF-8. Only identifiers have to decode the multibyte sequences.
+
+constexpr bool IsAscii(char ch) { return static_cast<unsigned char>(ch) < 0x80; }
+
+// A decoded code point and the number of bytes of its sequence. The length is 0 when the sequence
+// is not valid UTF-8: a stray continuation byte, an overlong form, a surrogate, a code point above
+// U+10FFFF or a sequence which is cut off by end.
+struct DecodeResult {
+  uint32_t code_point;
+  unsigned length;
+};
+
+constexpr DecodeResult Decode(const char* begin, const char* end) {
+  if (begin == end) {
+    return {0, 0};
+  }
+  auto byte = [&](ptrdiff_t i) { return static_cast<unsigned char>(begin[i]); };
+  unsigned char lead = byte(0);
+  if (lead < 0x80) {
+    return {lead, 1};
+  }
+
+  unsigned length = 0;
+  uint32_t code_point = 0;
+  uint32_t min = 0;
+  if ((lead >= 0xC2) && (lead <= 0xDF)) {
+    length = 2;
+    code_point = lead & 0x1F;
+    min = 0x80;
+  } else if ((lead & 0xF0) == 0xE0) {
+    length = 3;
+    code_point = lead & 0x0F;
+    min = 0x800;
+  } else if ((lead >= 0xF0) && (lead <= 0xF4)) {
+    length = 4;
+    code_point = lead & 0x07;
+    min = 0x10000;
+  } else {
+    return {0, 0};  // continuation byte or a lead byte which is never valid
+  }
+
+  if (end - begin < static_cast<ptrdiff_t>(length)) {
+    return {0, 0};
+  }
+  for (unsigned i = 1; i < length; ++i) {
+    if ((byte(i) & 0xC0) != 0x80) {
+      return {0, 0};
+    }
+    code_point = (code_point << 6) | (byte(i) & 0x3F);
+  }
+  if ((code_point < min) || (code_point > 0x10FFFF) || ((code_point >= 0xD800) && (code_point <= 0xDFFF))) {
+    return {0, 0};
+  }
+  return {code_point, length};
+}
+
+// ------------------------------------------------------------------------------------------------
+// VALIDATION
+// ------------------------------------------------------------------------------------------------
+
+// All validators return the first position in [begin, end) which is not part of a valid UTF-8
+// sequence or end.
+constexpr const char* ValidateScalar(const char* begin, const char* end) {
+  while (begin < end) {
+    if (IsAscii(*begin)) {
+      ++begin;
+      continue;
+    }
+    unsigned length = Decode(begin, end).length;
+    if (length == 0) {
+      return begin;
+    }
+    begin += length;
+  }
+  return begin;
+}
+
+// Blocks of ASCII are skipped by one compare. A block with a non ASCII byte is decoded up to its
+// end, the last sequence may reach into the next block.
+#if defined(KOLIBRI_LEXER_SSE2)
+inline const char* ValidateSse2(const char* begin, const char* end) {
+  while (end - begin >= 16) {
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(chunk));
+    if (mask == 0) {
+      begin += 16;
+      continue;
+    }
+    const char* block_end = begin + 16;
+    begin += simd::CountTrailingZeros(mask);
+    while (begin < block_end) {
+      unsigned length = IsAscii(*begin) ? 1 : Decode(begin, end).length;
+      if (length == 0) {
+        return begin;
+      }
+      begin += length;
+    }
+  }
+  return ValidateScalar(begin, end);
+}
+#endif
+
+#if defined(KOLIBRI_LEXER_AVX2)
+__attribute__((target("avx2"))) inline const char* ValidateAvx2(const char* begin, const char* end) {
+  while (end - begin >= 32) {
+    __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(chunk));
+    if (mask == 0) {
+      begin += 32;
+      continue;
+    }
+    const char* block_end = begin + 32;
+    begin += simd::CountTrailingZeros(mask);
+    while (begin < block_end) {
+      unsigned length = IsAscii(*begin) ? 1 : Decode(begin, end).length;
+      if (length == 0) {
+        return begin;
+      }
+      begin += length;
+    }
+  }
+  return ValidateSse2(begin, end);
+}
+#endif
+
+using ValidateFunction = const char* (*)(const char*, const char*);
+
+inline ValidateFunction SelectValidate() {
+#if defined(KOLIBRI_LEXER_AVX2)
+  if (__builtin_cpu_supports("avx2")) {
+    return &ValidateAvx2;
+  }
+#endif
+#if defined(KOLIBRI_LEXER_SSE2)
+  return &ValidateSse2;
+#else
+  return &ValidateScalar;
+#endif
+}
+
+// Returns the first position of an invalid sequence or end. Meant to be run once over a whole
+// buffer before it is lexed in UTF-8 mode.
+inline const char* Validate(const char* begin, const char* end) {
+  static const ValidateFunction validate = SelectValidate();
+  return validate(begin, end);
+}
+
+inline bool IsValid(const char* begin, const char* end) { return Validate(begin, end) == end; }
+
+// ------------------------------------------------------------------------------------------------
+// IDENTIFIERS
+// ------------------------------------------------------------------------------------------------
+
+struct CodePointRange {
+  uint32_t lo;
+  uint32_t hi;
+};
+
+// Non ASCII code points which may be part of an identifier, see C11 Annex D.1.
+inline constexpr CodePointRange kIdentifierRanges[] = {
+    {0x00A8, 0x00A8},   {0x00AA, 0x00AA},   {0x00AD, 0x00AD},   {0x00AF, 0x00AF},   {0x00B2, 0x00B5},   {0x00B7, 0x00BA},
+    {0x00BC, 0x00BE},   {0x00C0, 0x00D6},   {0x00D8, 0x00F6},   {0x00F8, 0x00FF},   {0x0100, 0x167F},   {0x1681, 0x180D},
+    {0x180F, 0x1FFF},   {0x200B, 0x200D},   {0x202A, 0x202E},   {0x203F, 0x2040},   {0x2054, 0x2054},   {0x2060, 0x206F},
+    {0x2070, 0x218F},   {0x2460, 0x24FF},   {0x2776, 0x2793},   {0x2C00, 0x2DFF},   {0x2E80, 0x2FFF},   {0x3004, 0x3007},
+    {0x3021, 0x302F},   {0x3031, 0x303F},   {0x3040, 0xD7FF},   {0xF900, 0xFD3D},   {0xFD40, 0xFDCF},   {0xFDF0, 0xFE44},
+    {0xFE47, 0xFFFD},   {0x10000, 0x1FFFD}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD}, {0x40000, 0x4FFFD}, {0x50000, 0x5FFFD},
+    {0x60000, 0x6FFFD}, {0x70000, 0x7FFFD}, {0x80000, 0x8FFFD}, {0x90000, 0x9FFFD}, {0xA0000, 0xAFFFD}, {0xB0000, 0xBFFFD},
+    {0xC0000, 0xCFFFD}, {0xD0000, 0xDFFFD}, {0xE0000, 0xEFFFD},
+};
+
+// Combining marks which may not start an identifier, see C11 Annex D.2.
+inline constexpr CodePointRange kIdentifierContinueOnlyRanges[] = {
+    {0x0300, 0x036F},
+    {0x1DC0, 0x1DFF},
+    {0x20D0, 0x20FF},
+    {0xFE20, 0xFE2F},
+};
+
+template <size_t N>
+constexpr bool InRanges(const CodePointRange (&ranges)[N], uint32_t code_point) {
+  size_t lo = 0;
+  size_t hi = N;
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (code_point < ranges[mid].lo) {
+      hi = mid;
+    } else if (code_point > ranges[mid].hi) {
+      lo = mid + 1;
+    } else {
+      return true;
+    }
+  }
+  return false;
+}
+
+constexpr bool IsIdentifierContinue(uint32_t code_point) { return InRanges(kIdentifierRanges, code_point); }
+
+constexpr bool IsIdentifierStart(uint32_t code_point) { return IsIdentifierContinue(code_point) && !InRanges(kIdentifierContinueOnlyRanges, code_point); }
+
+// Length of the non ASCII identifier char at begin or 0 when there is none.
+template <bool Start>
+constexpr unsigned IdentifierCharLength(const char* begin, const char* end) {
+  DecodeResult decoded = Decode(begin, end);
+  if ((decoded.length < 2) || !(Start ? IsIdentifierStart(decoded.code_point) : IsIdentifierContinue(decoded.code_point))) {
+    return 0;
+  }
+  return decoded.length;
+}
+
+}  // namespace utf8
+}  // namespace lexer
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef KOLIBRI_SRC_I_PARSER_FACTORY_H_
 #define KOLIBRI_SRC_I_PARSER_FACTORY_H_
 
+#include <utility>
 #include <vector>
 
 #include "parser/rule_id.h"
@@ -24,5 +25,43 @@ class IParserFactory {
   virtual nonterm_type CreateTermNonTermList(RuleId rule_id, std::vector<term_type> terms, std::vector<nonterm_type> nonterms) = 0;
 };
 
+// Base of factories which the parser calls statically. TDerived implements the Create methods
+// which take a rule id as templates on the type of the id:
+//
+//   template <typename TRuleId>
+//   nonterm_type CreateTerm(TRuleId rule_id, term_type term) { switch (rule_id) { ... } }
+//
+// Grammars with static dispatch pass a RuleIdConstant, so the switch on the rule id folds away.
+// Through the IParserFactory interface, e.g. for plugins, the same methods are called with a
+// RuleId. TDerived should be final, which makes calls of its CreateNull() non virtual too.
+template <typename TDerived, typename TNonTerm, typename TTerm>
+class StaticParserFactory : public IParserFactory<TNonTerm, TTerm> {
+ public:
+  using nonterm_type = TNonTerm;
+  using term_type = TTerm;
+
+  nonterm_type CreateEmpty(RuleId rule_id) override { return Derived().CreateEmpty(rule_id); }
+  nonterm_type CreateTerm(RuleId rule_id, term_type term) override { return Derived().CreateTerm(rule_id, term); }
+  nonterm_type CreateNonTerm(RuleId rule_id, nonterm_type nonterm) override { return Derived().CreateNonTerm(rule_id, nonterm); }
+  nonterm_type CreateTermNonTerm(RuleId rule_id, term_type term, nonterm_type nonterm) override {
+    return Derived().CreateTermNonTerm(rule_id, term, nonterm);
+  }
+  nonterm_type CreateNonTermNonTerm(RuleId rule_id, nonterm_type lhs, nonterm_type rhs) override {
+    return Derived().CreateNonTermNonTerm(rule_id, lhs, rhs);
+  }
+  nonterm_type CreateNonTermTermNonTerm(RuleId rule_id, nonterm_type lhs, term_type term, nonterm_type rhs) override {
+    return Derived().CreateNonTermTermNonTerm(rule_id, lhs, term, rhs);
+  }
+  nonterm_type CreateNonTermList(RuleId rule_id, std::vector<nonterm_type> statements) override {
+    return Derived().CreateNonTermList(rule_id, std::move(statements));
+  }
+  nonterm_type CreateTermNonTermList(RuleId rule_id, std::vector<term_type> terms, std::vector<nonterm_type> nonterms) override {
+    return Derived().CreateTermNonTermList(rule_id, std::move(terms), std::move(nonterms));
+  }
+
+ private:
+  TDerived& Derived() { return static_cast<TDerived&>(*this); }
+};
+
 }  // namespace parser
 #endif
\ No newline at end of file
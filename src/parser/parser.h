@@ -1,20 +1,26 @@
 #ifndef KOLIBRI_SRC_PARSER_H_
 #define KOLIBRI_SRC_PARSER_H_
 
+#include <iterator>
+#include <type_traits>
+
+#include "base/token_buffer.h"
 #include "parser/i_parser_factory.h"
+#include "parser/parser_rules.h"
 #include "parser/rule_id.h"
 
 namespace parser {
 
-
-
-template <typename Grammar>
+// TFactory is IParserFactory, whose methods are called virtually, or a concrete factory, e.g. one
+// derived from StaticParserFactory. Grammars with static dispatch call a concrete factory directly.
+template <typename Grammar, typename TFactory = IParserFactory<typename Grammar::nonterm_type, typename Grammar::term_type>>
 class Parser {
  public:
   using nonterm_type = typename Grammar::nonterm_type;
   using term_type = typename Grammar::term_type;
+  using iterator_type = typename Grammar::iterator_type;
 
-  explicit Parser(IParserFactory<nonterm_type, term_type>& parser_factory) : parser_factory_(parser_factory) {}
+  explicit Parser(TFactory& parser_factory) : parser_factory_(parser_factory) {}
 
   ~Parser() {}
 
@@ -25,31 +31,69 @@ class Parser {
     nonterm_type node;
     bool is_error;
     const char* error_msg;
+    const char* error_position;  // where in the source the error occurred or nullptr
   };
 
+  // Parses the given range of tokens. A range of another iterator type than the one of the
+  // grammar, e.g. a LexerIterator range, is materialized in a token buffer first.
   template <typename Iterator>
   ExprResult Expr(Iterator begin, Iterator end) {
+    if constexpr (std::is_same<Iterator, iterator_type>::value) {
+      return ExprImpl(begin, end);
+    } else {
+      token_buffer_.Assign(begin, end);
+      return ExprImpl(token_buffer_.begin(), token_buffer_.end());
+    }
+  }
+
+ private:
+  ExprResult ExprImpl(iterator_type begin, iterator_type end) {
     auto it = begin;
 
-    auto res = parser_grammar_.Match(parser_factory_, RuleId::kRule0, it, end);
+    parser_grammar_.Reset();
+    auto res = MatchRule0(it, end);
 
     if (res.is_error) {
-      return {res.node, true, res.msg};
+      // the only error raised by the rules is an unexpected end of the tokens
+      return {res.node, true, res.msg, EndPosition(begin, end)};
     }
     if (!res.is_match) {
-      return {parser_factory_.CreateNull(), true, "Error: Rule#0 doesnt't match"};
+      // it is still at begin unless the grammar stops at the token which doesn't fit
+      return {parser_factory_.CreateNull(), true, "Error: Rule#0 doesnt't match", TokenPosition(it, end)};
     }
 
     if (it == end) {
-      return {res.node, false, res.msg};
+      return {res.node, false, res.msg, nullptr};
     } else {
-      return {parser_factory_.CreateNull(), true, "ERROR: Tokens left"};
+      return {parser_factory_.CreateNull(), true, "ERROR: Tokens left", TokenPosition(it, end)};
     }
   }
 
- private:
-  IParserFactory<nonterm_type, term_type>& parser_factory_;
+  typename Grammar::result_type MatchRule0(iterator_type& it, iterator_type end) {
+    if constexpr (std::is_base_of<StaticDispatchGrammarTag, Grammar>::value) {
+      return parser_grammar_.template MatchRule<RuleId::kRule0>(parser_factory_, it, end);
+    } else {
+      return parser_grammar_.Match(parser_factory_, RuleId::kRule0, it, end);
+    }
+  }
+
+  static const char* TokenPosition(iterator_type it, iterator_type end) { return it != end ? (*it).GetValue().data() : nullptr; }
+
+  // Position behind the last token. Only known when the tokens can be iterated backwards.
+  static const char* EndPosition(iterator_type begin, iterator_type end) {
+    using category = typename std::iterator_traits<iterator_type>::iterator_category;
+    if constexpr (std::is_base_of<std::bidirectional_iterator_tag, category>::value) {
+      if (begin != end) {
+        auto last = (*std::prev(end)).GetValue();
+        return last.data() + last.size();
+      }
+    }
+    return nullptr;
+  }
+
+  TFactory& parser_factory_;
   Grammar parser_grammar_;
+  base::TokenBuffer<term_type> token_buffer_;
 };
 
 }  // namespace parser
@@ -0,0 +1,741 @@
+#ifndef KOLIBRI_SRC_PARSER_LL1_GRAMMAR_H_
+#define KOLIBRI_SRC_PARSER_LL1_GRAMMAR_H_
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "parser/i_parser_factory.h"
+#include "parser/parser_rules.h"
+#include "parser/rule_id.h"
+
+namespace parser {
+
+// Table driven LL(1) backend for the grammars of parser_rules.h. The rules are flattened at compile
+// time into an array of nodes, each ordered choice gets a row of a predictive parse table which maps
+// the next token to the alternative to take. The parser walks the nodes with an explicit stack, so
+// it never backtracks and the depth of the input isn't limited by the call stack.
+//
+// Only grammars which are LL(1) can be parsed this way: every term predicate has to define its token
+// id as kId (below 64) and the alternatives of a choice or a repetition must be told apart by the
+// next token. FindLL1Conflicts() lists what is in the way, LL1ParserGrammar refuses to compile
+// otherwise.
+
+enum class LL1NodeKind { kUnsupported, kEmpty, kTerm, kNonTerm, kChoice, kOptional, kRepeat, kSequence, kRule, kPrecedence, kOperator };
+
+struct LL1Node {
+  LL1NodeKind kind = LL1NodeKind::kUnsupported;
+  unsigned value = 0;  // token id, called rule, minimum count, production index, row of the parse table or rule of an operation
+  unsigned rule = 0;   // rule which contains the node
+  unsigned size = 1;   // number of nodes of the subtree
+  FirstSet first = kEmptyFirstSet;
+  unsigned precedence = 0;  // of an operator
+  bool right_associative = false;
+};
+
+// The tokens which may follow a node, end stands for the end of the input.
+struct LL1FollowSet {
+  uint64_t ids;
+  bool end;
+
+  constexpr bool operator==(const LL1FollowSet& rhs) const { return (ids == rhs.ids) && (end == rhs.end); }
+  constexpr bool operator!=(const LL1FollowSet& rhs) const { return !(*this == rhs); }
+};
+
+constexpr LL1FollowSet LL1FollowUnion(LL1FollowSet lhs, LL1FollowSet rhs) { return {lhs.ids | rhs.ids, lhs.end || rhs.end}; }
+constexpr LL1FollowSet LL1FollowUnion(LL1FollowSet lhs, FirstSet rhs) { return {lhs.ids | rhs.ids, lhs.end}; }
+
+enum class LL1ConflictKind {
+  kUnknownToken,  // a term predicate without kId or an expression which isn't supported
+  kFirstFirst,    // two alternatives can start with the same token
+  kFirstFollow,   // an alternative can start with a token which may also follow the empty one
+  kNullable       // more than one alternative matches the empty input or a repetition may match it
+};
+
+struct LL1Conflict {
+  LL1ConflictKind kind = LL1ConflictKind::kUnknownToken;
+  RuleId rule = RuleId::kRule0;
+  unsigned token_id = 0;  // the first token which is in conflict
+};
+
+constexpr size_t kMaxLL1Conflicts = 16;
+
+struct LL1Conflicts {
+  size_t count = 0;  // may be larger than the number of conflicts which are kept
+  std::array<LL1Conflict, kMaxLL1Conflicts> conflicts{};
+
+  constexpr void Add(LL1ConflictKind kind, unsigned rule, uint64_t token_ids) {
+    if (count < kMaxLL1Conflicts) {
+      unsigned token_id = 0;
+      while ((token_ids != 0) && ((token_ids & 1) == 0)) {
+        token_ids >>= 1;
+        token_id++;
+      }
+      conflicts[count] = {kind, static_cast<RuleId>(rule), token_id};
+    }
+    count++;
+  }
+};
+
+// ------------------------------------------------------------------------------------------------
+// LAYOUT
+// ------------------------------------------------------------------------------------------------
+
+// The nodes of an expression in pre-order, the children of a node follow it directly. kSize is the
+// number of nodes and kChoices the number of rows of the parse table needed by the expression.
+template <typename TExpression>
+struct LL1Layout {
+  static constexpr unsigned kSize = 1;
+  static constexpr unsigned kChoices = 0;
+
+  template <typename TNodes>
+  static constexpr void Emit(TNodes& nodes, unsigned index, unsigned rule, unsigned /*production*/, const FirstSet* /*rules*/) {
+    nodes[index] = {LL1NodeKind::kUnsupported, 0, rule, kSize, {0, true, false}};
+  }
+};
+
+template <>
+struct LL1Layout<EmptyExpr> {
+  static constexpr unsigned kSize = 1;
+  static constexpr unsigned kChoices = 0;
+
+  template <typename TNodes>
+  static constexpr void Emit(TNodes& nodes, unsigned index, unsigned rule, unsigned /*production*/, const FirstSet* rules) {
+    nodes[index] = {LL1NodeKind::kEmpty, 0, rule, kSize, FirstSetOf<EmptyExpr>::Get(rules)};
+  }
+};
+
+template <typename TermPredicate>
+struct LL1Layout<TermExpr<TermPredicate>> {
+  static constexpr unsigned kSize = 1;
+  static constexpr unsigned kChoices = 0;
+
+  template <typename TNodes>
+  static constexpr void Emit(TNodes& nodes, unsigned index, unsigned rule, unsigned /*production*/, const FirstSet* rules) {
+    FirstSet first = FirstSetOf<TermExpr<TermPredicate>>::Get(rules);
+    unsigned id = 0;
+    while ((first.ids >> id) > 1) {
+      id++;
+    }
+    nodes[index] = {LL1NodeKind::kTerm, id, rule, kSize, first};
+  }
+};
+
+template <RuleId RId>
+struct LL1Layout<NonTermExpr<RId>> {
+  static constexpr unsigned kSize = 1;
+  static constexpr unsigned kChoices = 0;
+
+  template <typename TNodes>
+  static constexpr void Emit(TNodes& nodes, unsigned index, unsigned rule, unsigned /*production*/, const FirstSet* rules) {
+    nodes[index] = {LL1NodeKind::kNonTerm, static_cast<unsigned>(RId), rule, kSize, FirstSetOf<NonTermExpr<RId>>::Get(rules)};
+  }
+};
+
+template <typename... Expressions>
+struct LL1Layout<OrderedChoiceExpr<Expressions...>> {
+  static constexpr unsigned kSize = 1 + (LL1Layout<Expressions>::kSize + ...);
+  static constexpr unsigned kChoices = 1 + (LL1Layout<Expressions>::kChoices + ...);
+
+  template <typename TNodes>
+  static constexpr void Emit(TNodes& nodes, unsigned index, unsigned rule, unsigned production, const FirstSet* rules) {
+    nodes[index] = {LL1NodeKind::kChoice, 0, rule, kSize, FirstSetOf<OrderedChoiceExpr<Expressions...>>::Get(rules)};
+    unsigned child = index + 1;
+    ((LL1Layout<Expressions>::Emit(nodes, child, rule, production, rules), child += LL1Layout<Expressions>::kSize), ...);
+  }
+};
+
+template <typename Expression>
+struct LL1Layout<OptionalExpr<Expression>> {
+  static constexpr unsigned kSize = 1 + LL1Layout<Expression>::kSize;
+  static constexpr unsigned kChoices = LL1Layout<Expression>::kChoices;
+
+  template <typename TNodes>
+  static constexpr void Emit(TNodes& nodes, unsigned index, unsigned rule, unsigned production, const FirstSet* rules) {
+    nodes[index] = {LL1NodeKind::kOptional, 0, rule, kSize, FirstSetOf<OptionalExpr<Expression>>::Get(rules)};
+    LL1Layout<Expression>::Emit(nodes, index + 1, rule, production, rules);
+  }
+};
+
+template <unsigned N, typename Expression>
+struct LL1Layout<NMatchesOrMoreExpr<N, Expression>> {
+  static constexpr unsigned kSize = 1 + LL1Layout<Expression>::kSize;
+  static constexpr unsigned kChoices = LL1Layout<Expression>::kChoices;
+
+  template <typename TNodes>
+  static constexpr void Emit(TNodes& nodes, unsigned index, unsigned rule, unsigned production, const FirstSet* rules) {
+    nodes[index] = {LL1NodeKind::kRepeat, N, rule, kSize, FirstSetOf<NMatchesOrMoreExpr<N, Expression>>::Get(rules)};
+    LL1Layout<Expression>::Emit(nodes, index + 1, rule, production, rules);
+  }
+};
+
+template <typename... Expressions>
+struct LL1Layout<SequenceExpr<Expressions...>> {
+  static constexpr unsigned kSize = 1 + (LL1Layout<Expressions>::kSize + ...);
+  static constexpr unsigned kChoices = (LL1Layout<Expressions>::kChoices + ...);
+
+  template <typename TNodes>
+  static constexpr void Emit(TNodes& nodes, unsigned index, unsigned rule, unsigned production, const FirstSet* rules) {
+    nodes[index] = {LL1NodeKind::kSequence, 0, rule, kSize, FirstSetOf<SequenceExpr<Expressions...>>::Get(rules)};
+    unsigned child = index + 1;
+    ((LL1Layout<Expressions>::Emit(nodes, child, rule, production, rules), child += LL1Layout<Expressions>::kSize), ...);
+  }
+};
+
+template <template <class, class> class Production, typename Expression>
+struct LL1Layout<Rule<Production, Expression>> {
+  static constexpr unsigned kSize = 1 + LL1Layout<Expression>::kSize;
+  static constexpr unsigned kChoices = LL1Layout<Expression>::kChoices;
+  static constexpr unsigned kProductions = 1;
+
+  template <typename TNodes>
+  static constexpr void Emit(TNodes& nodes, unsigned index, unsigned rule, unsigned production, const FirstSet* rules) {
+    nodes[index] = {LL1NodeKind::kRule, production, rule, kSize, FirstSetOf<Rule<Production, Expression>>::Get(rules)};
+    LL1Layout<Expression>::Emit(nodes, index + 1, rule, production, rules);
+  }
+};
+
+// The operand is followed by one node per operator.
+template <typename Operand, typename... Operators>
+struct LL1Layout<PrecedenceExpr<Operand, Operators...>> {
+  static constexpr unsigned kSize = 1 + LL1Layout<Operand>::kSize + sizeof...(Operators);
+  static constexpr unsigned kChoices = LL1Layout<Operand>::kChoices;
+
+  template <typename TNodes>
+  static constexpr void Emit(TNodes& nodes, unsigned index, unsigned rule, unsigned production, const FirstSet* rules) {
+    nodes[index] = {LL1NodeKind::kPrecedence, 0, rule, kSize, FirstSetOf<PrecedenceExpr<Operand, Operators...>>::Get(rules)};
+    LL1Layout<Operand>::Emit(nodes, index + 1, rule, production, rules);
+    unsigned child = index + 1 + LL1Layout<Operand>::kSize;
+    ((nodes[child++] = {LL1NodeKind::kOperator, static_cast<unsigned>(Operators::kRuleId), rule, 1, FirstSet{uint64_t{1} << Operators::kTokenId, false, false},
+                        Operators::kPrecedence, Operators::kRightAssociative}),
+     ...);
+  }
+};
+
+// Each alternative has a production of its own.
+template <typename... Args>
+struct LL1Layout<OrderedChoiceRules<Args...>> {
+  static constexpr unsigned kSize = 1 + (LL1Layout<Args>::kSize + ...);
+  static constexpr unsigned kChoices = 1 + (LL1Layout<Args>::kChoices + ...);
+  static constexpr unsigned kProductions = sizeof...(Args);
+
+  template <typename TNodes>
+  static constexpr void Emit(TNodes& nodes, unsigned index, unsigned rule, unsigned production, const FirstSet* rules) {
+    nodes[index] = {LL1NodeKind::kChoice, 0, rule, kSize, FirstSetOf<OrderedChoiceRules<Args...>>::Get(rules)};
+    unsigned child = index + 1;
+    ((LL1Layout<Args>::Emit(nodes, child, rule, production++, rules), child += LL1Layout<Args>::kSize), ...);
+  }
+};
+
+// ------------------------------------------------------------------------------------------------
+// TABLES
+// ------------------------------------------------------------------------------------------------
+
+constexpr unsigned kLL1EndLookahead = 64;      // column of the parse table for the end of the input
+constexpr unsigned kLL1UnknownLookahead = 65;  // column for token ids above 63, which no alternative starts with
+constexpr unsigned kLL1NoAlternative = ~0u;
+
+template <size_t NRules, size_t NNodes, size_t NChoices>
+struct LL1Tables {
+  std::array<unsigned, NRules> rule_roots{};
+  std::array<LL1Node, NNodes> nodes{};
+  std::array<LL1FollowSet, NNodes> follow{};
+  std::array<std::array<unsigned, kLL1UnknownLookahead + 1>, NChoices> parse_table{};  // next token -> node of the alternative
+  LL1Conflicts conflicts{};
+};
+
+template <typename... Rules>
+using ll1_tables_type = LL1Tables<sizeof...(Rules), (LL1Layout<Rules>::kSize + ...), (LL1Layout<Rules>::kChoices + ...)>;
+
+// The operators of a precedence node.
+template <typename TNodes>
+constexpr FirstSet LL1OperatorFirstSet(const TNodes& nodes, unsigned index) {
+  FirstSet first = kEmptyFirstSet;
+  for (unsigned child = index + 1 + nodes[index + 1].size; child < index + nodes[index].size; ++child) {
+    first.ids |= nodes[child].first.ids;
+  }
+  return first;
+}
+
+template <size_t NNodes>
+constexpr void ComputeLL1Follow(const std::array<LL1Node, NNodes>& nodes, const unsigned* rule_roots, size_t num_rules,
+                                std::array<LL1FollowSet, NNodes>& follow) {
+  // any rule may be the one the parser starts with
+  for (size_t rule = 0; rule < num_rules; ++rule) {
+    follow[rule_roots[rule]].end = true;
+  }
+
+  bool changed = true;
+  while (changed) {
+    auto next = follow;
+    for (unsigned i = 0; i < NNodes; ++i) {
+      const LL1Node& node = nodes[i];
+      unsigned children_end = i + node.size;
+      switch (node.kind) {
+        case LL1NodeKind::kSequence: {
+          unsigned children[NNodes] = {};
+          unsigned num_children = 0;
+          for (unsigned child = i + 1; child < children_end; child += nodes[child].size) {
+            children[num_children++] = child;
+          }
+          LL1FollowSet rest = next[i];
+          for (unsigned k = num_children; k > 0; --k) {
+            unsigned child = children[k - 1];
+            next[child] = LL1FollowUnion(next[child], rest);
+            rest = nodes[child].first.nullable ? LL1FollowUnion(rest, nodes[child].first) : LL1FollowSet{nodes[child].first.ids, false};
+          }
+          break;
+        }
+        case LL1NodeKind::kChoice:
+        case LL1NodeKind::kOptional:
+        case LL1NodeKind::kRule:
+          for (unsigned child = i + 1; child < children_end; child += nodes[child].size) {
+            next[child] = LL1FollowUnion(next[child], next[i]);
+          }
+          break;
+        case LL1NodeKind::kRepeat:
+          next[i + 1] = LL1FollowUnion(LL1FollowUnion(next[i + 1], next[i]), nodes[i + 1].first);
+          break;
+        case LL1NodeKind::kPrecedence:
+          next[i + 1] = LL1FollowUnion(LL1FollowUnion(next[i + 1], next[i]), LL1OperatorFirstSet(nodes, i));
+          break;
+        case LL1NodeKind::kNonTerm:
+          next[rule_roots[node.value]] = LL1FollowUnion(next[rule_roots[node.value]], next[i]);
+          break;
+        default:
+          break;
+      }
+    }
+    changed = false;
+    for (unsigned i = 0; i < NNodes; ++i) {
+      changed = changed || (next[i] != follow[i]);
+    }
+    follow = next;
+  }
+}
+
+template <typename... Rules>
+constexpr ll1_tables_type<Rules...> MakeLL1Tables() {
+  constexpr std::array<FirstSet, sizeof...(Rules)> kRuleFirstSets = MakeFirstSets<Rules...>();
+  ll1_tables_type<Rules...> tables{};
+
+  unsigned index = 0;
+  unsigned rule = 0;
+  unsigned production = 0;
+  ((tables.rule_roots[rule] = index,                                                              //
+    LL1Layout<Rules>::Emit(tables.nodes, index, rule, production, kRuleFirstSets.data()),         //
+    index += LL1Layout<Rules>::kSize, production += LL1Layout<Rules>::kProductions, rule++),      //
+   ...);
+
+  ComputeLL1Follow(tables.nodes, tables.rule_roots.data(), sizeof...(Rules), tables.follow);
+
+  unsigned row = 0;
+  for (unsigned i = 0; i < tables.nodes.size(); ++i) {
+    LL1Node& node = tables.nodes[i];
+    const LL1FollowSet& follow = tables.follow[i];
+    unsigned children_end = i + node.size;
+
+    if (node.first.any) {
+      tables.conflicts.Add(LL1ConflictKind::kUnknownToken, node.rule, 0);
+    }
+
+    if ((node.kind == LL1NodeKind::kOptional) || (node.kind == LL1NodeKind::kRepeat)) {
+      const FirstSet& child = tables.nodes[i + 1].first;
+      if (child.nullable) {
+        tables.conflicts.Add(LL1ConflictKind::kNullable, node.rule, 0);
+      }
+      if ((child.ids & follow.ids) != 0) {
+        tables.conflicts.Add(LL1ConflictKind::kFirstFollow, node.rule, child.ids & follow.ids);
+      }
+    }
+
+    // an operator must not be able to follow the expression, the operand must consume a token
+    if (node.kind == LL1NodeKind::kPrecedence) {
+      uint64_t operators = LL1OperatorFirstSet(tables.nodes, i).ids;
+      if (tables.nodes[i + 1].first.nullable) {
+        tables.conflicts.Add(LL1ConflictKind::kNullable, node.rule, 0);
+      }
+      if ((operators & follow.ids) != 0) {
+        tables.conflicts.Add(LL1ConflictKind::kFirstFollow, node.rule, operators & follow.ids);
+      }
+    }
+
+    if (node.kind != LL1NodeKind::kChoice) {
+      continue;
+    }
+
+    // the first alternative which can start with a token wins, the same as with an ordered choice
+    node.value = row++;
+    auto& entries = tables.parse_table[node.value];
+    for (auto& entry : entries) {
+      entry = kLL1NoAlternative;
+    }
+    uint64_t seen = 0;
+    unsigned nullable_alternative = kLL1NoAlternative;
+    for (unsigned child = i + 1; child < children_end; child += tables.nodes[child].size) {
+      const FirstSet& first = tables.nodes[child].first;
+      if ((first.ids & seen) != 0) {
+        tables.conflicts.Add(LL1ConflictKind::kFirstFirst, node.rule, first.ids & seen);
+      }
+      seen |= first.ids;
+      for (unsigned id = 0; id < kLL1EndLookahead; ++id) {
+        if (((first.ids >> id) & 1) && (entries[id] == kLL1NoAlternative)) {
+          entries[id] = child;
+        }
+      }
+      if (first.nullable) {
+        if (nullable_alternative != kLL1NoAlternative) {
+          tables.conflicts.Add(LL1ConflictKind::kNullable, node.rule, 0);
+        } else {
+          nullable_alternative = child;
+        }
+      }
+    }
+
+    // the empty alternative is taken for the tokens which may follow the choice
+    if (nullable_alternative != kLL1NoAlternative) {
+      if ((seen & follow.ids) != 0) {
+        tables.conflicts.Add(LL1ConflictKind::kFirstFollow, node.rule, seen & follow.ids);
+      }
+      for (unsigned id = 0; id < kLL1EndLookahead; ++id) {
+        if (((follow.ids >> id) & 1) && (entries[id] == kLL1NoAlternative)) {
+          entries[id] = nullable_alternative;
+        }
+      }
+      if (follow.end) {
+        entries[kLL1EndLookahead] = nullable_alternative;
+      }
+    }
+  }
+  return tables;
+}
+
+// The reasons why the rules aren't LL(1), no conflicts means they are.
+template <typename... Rules>
+constexpr LL1Conflicts FindLL1Conflicts() {
+  return MakeLL1Tables<Rules...>().conflicts;
+}
+
+// ------------------------------------------------------------------------------------------------
+// GRAMMAR
+// ------------------------------------------------------------------------------------------------
+
+template <typename TRule, typename TNonTerm, typename TTerm>
+struct ll1_rule_production;
+
+template <template <class, class> class Production, typename Expression, typename TNonTerm, typename TTerm>
+struct ll1_rule_production<Rule<Production, Expression>, TNonTerm, TTerm> {
+  using type = Production<TNonTerm, TTerm>;
+};
+
+template <typename TRule>
+struct ll1_rule_alternatives {
+  using type = std::tuple<TRule>;
+};
+
+template <typename... Args>
+struct ll1_rule_alternatives<OrderedChoiceRules<Args...>> {
+  using type = std::tuple<Args...>;
+};
+
+template <typename TAlternatives, typename TNonTerm, typename TTerm>
+struct ll1_production_variant;
+
+// The last production collects the operands of precedence expressions.
+template <typename... Alternatives, typename TNonTerm, typename TTerm>
+struct ll1_production_variant<std::tuple<Alternatives...>, TNonTerm, TTerm> {
+  using type = std::variant<typename ll1_rule_production<Alternatives, TNonTerm, TTerm>::type..., BypassLastTermProduction<TNonTerm, TTerm>>;
+};
+
+// Drop in replacement of ParserGrammar for parser::Parser. It calls the same factory methods with
+// the same arguments as ParserGrammar does for every input both accept. On a syntax error Match()
+// returns no match and leaves it at the token which doesn't fit. As with ParserGrammar,
+// MatchRule<>() calls the factory statically and the virtual Match() through IParserFactory.
+template <typename TNonTerm, typename Iterator, typename... Terminals>
+class LL1ParserGrammar : public IParserGrammar<TNonTerm, Iterator>, public StaticDispatchGrammarTag {
+ public:
+  using nonterm_type = TNonTerm;
+  using iterator_type = Iterator;
+  using term_type = typename iterator_type::value_type;
+  using result_type = RuleResult<nonterm_type>;
+
+  static constexpr ll1_tables_type<Terminals...> kTables = MakeLL1Tables<Terminals...>();
+  static_assert(kTables.conflicts.count == 0, "LL1ParserGrammar: the grammar isn't LL(1), see FindLL1Conflicts()");
+
+  LL1ParserGrammar() : stack_(), productions_(), operations_() {}
+
+  result_type Match(IParserFactory<nonterm_type, term_type>& parser_factory, RuleId rule_id, iterator_type& it, iterator_type end) override {
+    return Parse(parser_factory, rule_id, it, end);
+  }
+
+  template <RuleId RId, typename TFactory>
+  result_type MatchRule(TFactory& parser_factory, iterator_type& it, iterator_type end) {
+    return Parse(parser_factory, RId, it, end);
+  }
+
+  void Reset() {}
+
+ private:
+  template <typename TFactory>
+  result_type Parse(TFactory& parser_factory, RuleId rule_id, iterator_type& it, iterator_type end) {
+    assert(static_cast<size_t>(rule_id) < sizeof...(Terminals));
+    stack_.clear();
+    productions_.clear();
+    operations_.clear();
+    stack_.push_back({kTables.rule_roots[static_cast<size_t>(rule_id)], 0});
+
+    while (true) {
+      Frame& frame = stack_.back();
+      const LL1Node& node = kTables.nodes[frame.node];
+      switch (node.kind) {
+        case LL1NodeKind::kEmpty:
+          stack_.pop_back();
+          break;
+
+        case LL1NodeKind::kTerm:
+          if (it == end) {
+            return UnexpectedEnd(parser_factory);
+          }
+          if (static_cast<unsigned>((*it).GetId()) != node.value) {
+            return NoMatch(parser_factory);
+          }
+          std::visit([&](auto& production) { production.AddTerminal(*it); }, productions_.back());
+          ++it;
+          stack_.pop_back();
+          break;
+
+        case LL1NodeKind::kNonTerm:
+          frame.node = kTables.rule_roots[node.value];
+          break;
+
+        case LL1NodeKind::kChoice: {
+          unsigned alternative = kTables.parse_table[node.value][Lookahead(it, end)];
+          if (alternative == kLL1NoAlternative) {
+            return it == end ? UnexpectedEnd(parser_factory) : NoMatch(parser_factory);
+          }
+          frame.node = alternative;
+          break;
+        }
+
+        case LL1NodeKind::kOptional:
+          if (StartsWith(frame.node + 1, it, end)) {
+            frame.node = frame.node + 1;
+          } else {
+            stack_.pop_back();
+          }
+          break;
+
+        case LL1NodeKind::kRepeat:
+          if ((frame.state < node.value) || StartsWith(frame.node + 1, it, end)) {
+            frame.state++;
+            stack_.push_back({frame.node + 1, 0});
+          } else {
+            stack_.pop_back();
+          }
+          break;
+
+        case LL1NodeKind::kSequence:
+          if (frame.state == 0) {
+            frame.state = frame.node + 1;
+          }
+          if (frame.state == frame.node + node.size) {
+            stack_.pop_back();
+          } else {
+            unsigned child = frame.state;
+            frame.state += kTables.nodes[child].size;
+            stack_.push_back({child, 0});
+          }
+          break;
+
+        case LL1NodeKind::kRule:
+          if (frame.state == 0) {
+            frame.state = 1;
+            kEmplace[node.value](productions_, static_cast<RuleId>(node.rule));
+            stack_.push_back({frame.node + 1, 0});
+          } else {
+            auto nonterm = kCreate<TFactory>[node.value](productions_.back(), parser_factory);
+            productions_.pop_back();
+            stack_.pop_back();
+            if (productions_.empty()) {
+              return result_type(true, nonterm, false, "");
+            }
+            std::visit([&](auto& production) { production.AddNonTerminal(nonterm); }, productions_.back());
+          }
+          break;
+
+        // Operator precedence parsing without recursion: an operand waits with its operator on
+        // operations_ until an operator which doesn't bind stronger or the end of the expression.
+        case LL1NodeKind::kPrecedence: {
+          if (frame.state == 0) {
+            frame.state = 1;
+            frame.base = static_cast<unsigned>(operations_.size());
+          } else {
+            auto operand = std::get<kOperandProduction>(productions_.back()).Create(parser_factory);
+            productions_.pop_back();
+            unsigned op = FindOperator(frame.node, it, end);
+            ReduceOperations(parser_factory, frame.base, op, operand);
+            if (op == kLL1NoAlternative) {
+              stack_.pop_back();
+              std::visit([&](auto& production) { production.AddNonTerminal(operand); }, productions_.back());
+              break;
+            }
+            operations_.push_back({operand, *it, op});
+            ++it;
+          }
+          productions_.emplace_back(std::in_place_index<kOperandProduction>, static_cast<RuleId>(node.rule));
+          stack_.push_back({frame.node + 1, 0});
+          break;
+        }
+
+        default:
+          assert(false);
+          return NoMatch(parser_factory);
+      }
+    }
+  }
+
+  struct Frame {
+    unsigned node;
+    unsigned state;     // next child of a sequence, count of a repetition or whether a rule or precedence node was entered
+    unsigned base = 0;  // operations_ of the enclosing expressions
+  };
+
+  struct Operation {
+    nonterm_type lhs;
+    term_type term;
+    unsigned op;  // operator node
+  };
+
+  using alternatives_type = decltype(std::tuple_cat(std::declval<typename ll1_rule_alternatives<Terminals>::type>()...));
+  using production_type = typename ll1_production_variant<alternatives_type, nonterm_type, term_type>::type;
+  using emplace_function = void (*)(std::vector<production_type>&, RuleId);
+
+  template <size_t I>
+  static void EmplaceProduction(std::vector<production_type>& productions, RuleId rule_id) {
+    productions.emplace_back(std::in_place_index<I>, rule_id);
+  }
+
+  template <size_t... Indices>
+  static constexpr std::array<emplace_function, sizeof...(Indices)> MakeEmplaceTable(std::index_sequence<Indices...>) {
+    return {{&LL1ParserGrammar::template EmplaceProduction<Indices>...}};
+  }
+
+  static constexpr size_t kOperandProduction = std::variant_size_v<production_type> - 1;
+
+  static constexpr std::array<emplace_function, std::variant_size_v<production_type>> kEmplace =
+      MakeEmplaceTable(std::make_index_sequence<std::variant_size_v<production_type>>());
+
+  // The rule of each production, it is passed to the factory as RuleIdConstant.
+  static constexpr std::array<RuleId, std::variant_size_v<production_type>> MakeProductionRules() {
+    std::array<RuleId, std::variant_size_v<production_type>> rules{};
+    for (const LL1Node& node : kTables.nodes) {
+      if (node.kind == LL1NodeKind::kRule) {
+        rules[node.value] = static_cast<RuleId>(node.rule);
+      }
+    }
+    return rules;
+  }
+
+  static constexpr std::array<RuleId, std::variant_size_v<production_type>> kProductionRules = MakeProductionRules();
+
+  template <typename TFactory>
+  using create_function = nonterm_type (*)(production_type&, TFactory&);
+
+  template <size_t I, typename TFactory>
+  static nonterm_type CreateNode(production_type& production, TFactory& parser_factory) {
+    return std::get<I>(production).Create(parser_factory, RuleIdConstant<kProductionRules[I]>());
+  }
+
+  template <typename TFactory, size_t... Indices>
+  static constexpr std::array<create_function<TFactory>, sizeof...(Indices)> MakeCreateTable(std::index_sequence<Indices...>) {
+    return {{&LL1ParserGrammar::template CreateNode<Indices, TFactory>...}};
+  }
+
+  template <typename TFactory>
+  static constexpr std::array<create_function<TFactory>, std::variant_size_v<production_type>> kCreate =
+      MakeCreateTable<TFactory>(std::make_index_sequence<std::variant_size_v<production_type>>());
+
+  template <typename TFactory>
+  using create_operation_function = nonterm_type (*)(TFactory&, const nonterm_type&, const term_type&, const nonterm_type&);
+
+  template <size_t I, typename TFactory>
+  static nonterm_type CreateOperation(TFactory& parser_factory, const nonterm_type& lhs, const term_type& term, const nonterm_type& rhs) {
+    return parser_factory.CreateNonTermTermNonTerm(RuleIdConstant<static_cast<RuleId>(I)>(), lhs, term, rhs);
+  }
+
+  template <typename TFactory, size_t... Indices>
+  static constexpr std::array<create_operation_function<TFactory>, sizeof...(Indices)> MakeCreateOperationTable(std::index_sequence<Indices...>) {
+    return {{&LL1ParserGrammar::template CreateOperation<Indices, TFactory>...}};
+  }
+
+  // indexed by the rule of the operator
+  template <typename TFactory>
+  static constexpr std::array<create_operation_function<TFactory>, sizeof...(Terminals)> kCreateOperation =
+      MakeCreateOperationTable<TFactory>(std::make_index_sequence<sizeof...(Terminals)>());
+
+  // The operator node of the precedence node which matches the next token.
+  static unsigned FindOperator(unsigned precedence_node, const iterator_type& it, const iterator_type& end) {
+    const LL1Node& node = kTables.nodes[precedence_node];
+    for (unsigned op = precedence_node + 1 + kTables.nodes[precedence_node + 1].size; op < precedence_node + node.size; ++op) {
+      if (StartsWith(op, it, end)) {
+        return op;
+      }
+    }
+    return kLL1NoAlternative;
+  }
+
+  // Combines rhs with the waiting operations which bind stronger than the operator op, all of them
+  // if there is no operator.
+  template <typename TFactory>
+  void ReduceOperations(TFactory& parser_factory, unsigned base, unsigned op, nonterm_type& rhs) {
+    while (operations_.size() > base) {
+      Operation& operation = operations_.back();
+      const LL1Node& waiting = kTables.nodes[operation.op];
+      if (op != kLL1NoAlternative) {
+        const LL1Node& next = kTables.nodes[op];
+        if ((waiting.precedence < next.precedence) || ((waiting.precedence == next.precedence) && next.right_associative)) {
+          break;
+        }
+      }
+      assert(waiting.value < sizeof...(Terminals));
+      rhs = kCreateOperation<TFactory>[waiting.value](parser_factory, operation.lhs, operation.term, rhs);
+      operations_.pop_back();
+    }
+  }
+
+  static unsigned Lookahead(const iterator_type& it, const iterator_type& end) {
+    if (it == end) {
+      return kLL1EndLookahead;
+    }
+    auto id = static_cast<unsigned>((*it).GetId());
+    return id < kLL1EndLookahead ? id : kLL1UnknownLookahead;
+  }
+
+  static bool StartsWith(unsigned node, const iterator_type& it, const iterator_type& end) {
+    return (it != end) && kTables.nodes[node].first.Contains(static_cast<unsigned>((*it).GetId()));
+  }
+
+  template <typename TFactory>
+  result_type UnexpectedEnd(TFactory& parser_factory) {
+    return result_type(false, parser_factory.CreateNull(), true, "ERROR: Unexpected END");
+  }
+
+  template <typename TFactory>
+  result_type NoMatch(TFactory& parser_factory) {
+    return result_type(false, parser_factory.CreateNull(), false, "LL1ParserGrammar: Unexpected token");
+  }
+
+  std::vector<Frame> stack_;
+  std::vector<production_type> productions_;  // one per rule and operand on the stack
+  std::vector<Operation> operations_;         // operands waiting for their right hand side
+};
+
+}  // namespace parser
+
+#endif
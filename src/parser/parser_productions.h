@@ -10,6 +10,11 @@
 
 namespace parser {
 
+// A production collects the terminals and non terminals matched by a rule and creates the node of
+// the rule with the factory. Create() is a template on the factory, so factories which aren't
+// IParserFactories are called statically. The rule id is either the one the production was
+// constructed with or the one passed to Create(), which may be a RuleIdConstant.
+
 /// Produces a NOP in an ast.
 template <typename TNonTerm, typename TTerm>
 class EmptyProduction {
@@ -26,7 +31,11 @@ class EmptyProduction {
     // do nothing
   }
 
-  nonterm_type Create(IParserFactory<nonterm_type, term_type>& parser_factory) { return parser_factory.CreateEmpty(rule_id_); }
+  template <typename TFactory>
+  nonterm_type Create(TFactory& parser_factory) { return Create(parser_factory, rule_id_); }
+
+  template <typename TFactory, typename TRuleId>
+  nonterm_type Create(TFactory& parser_factory, TRuleId rule_id) { return parser_factory.CreateEmpty(rule_id); }
 
  private:
   RuleId rule_id_;
@@ -47,7 +56,11 @@ class BypassLastTermProduction {
   void AddNonTerminal(nonterm_type const& nonterminal) { 
     nonterminal_ = nonterminal; }
 
-  nonterm_type Create(IParserFactory<nonterm_type, term_type>& parser_factory) { return nonterminal_; }
+  template <typename TFactory>
+  nonterm_type Create(TFactory& /*parser_factory*/) { return nonterminal_; }
+
+  template <typename TFactory, typename TRuleId>
+  nonterm_type Create(TFactory& /*parser_factory*/, TRuleId /*rule_id*/) { return nonterminal_; }
 
  private:
   nonterm_type nonterminal_;
@@ -66,7 +79,11 @@ class TermProduction {
     // do nothing here
   }
 
-  nonterm_type Create(IParserFactory<nonterm_type, term_type>& parser_factory) { return parser_factory.CreateTerm(rule_id_, term0_); }
+  template <typename TFactory>
+  nonterm_type Create(TFactory& parser_factory) { return Create(parser_factory, rule_id_); }
+
+  template <typename TFactory, typename TRuleId>
+  nonterm_type Create(TFactory& parser_factory, TRuleId rule_id) { return parser_factory.CreateTerm(rule_id, term0_); }
 
  private:
   RuleId rule_id_;
@@ -86,8 +103,12 @@ class NonTermProduction {
     nonterm0_ = nonterminal;
   }
 
-  nonterm_type Create(IParserFactory<nonterm_type, term_type>& parser_factory) { 
-    return parser_factory.CreateNonTerm(rule_id_, nonterm0_); }
+  template <typename TFactory>
+  nonterm_type Create(TFactory& parser_factory) { return Create(parser_factory, rule_id_); }
+
+  template <typename TFactory, typename TRuleId>
+  nonterm_type Create(TFactory& parser_factory, TRuleId rule_id) { 
+    return parser_factory.CreateNonTerm(rule_id, nonterm0_); }
 
  private:
   RuleId rule_id_;
@@ -122,7 +143,11 @@ class NonTermNonTermProduction {
     }
    }
 
-  nonterm_type Create(IParserFactory<nonterm_type, term_type>& parser_factory) { return parser_factory.CreateNonTermNonTerm(rule_id_, lhs_, rhs_); }
+  template <typename TFactory>
+  nonterm_type Create(TFactory& parser_factory) { return Create(parser_factory, rule_id_); }
+
+  template <typename TFactory, typename TRuleId>
+  nonterm_type Create(TFactory& parser_factory, TRuleId rule_id) { return parser_factory.CreateNonTermNonTerm(rule_id, lhs_, rhs_); }
 
  private:
   RuleId rule_id_;
@@ -143,7 +168,11 @@ class TermNonTermProduction {
 
   void AddNonTerminal(nonterm_type const& nonterminal) { nonterminal_ = nonterminal; }
 
-  nonterm_type Create(IParserFactory<nonterm_type, term_type>& parser_factory) { return parser_factory.CreateTermNonTerm(rule_id_, terminal_, nonterminal_); }
+  template <typename TFactory>
+  nonterm_type Create(TFactory& parser_factory) { return Create(parser_factory, rule_id_); }
+
+  template <typename TFactory, typename TRuleId>
+  nonterm_type Create(TFactory& parser_factory, TRuleId rule_id) { return parser_factory.CreateTermNonTerm(rule_id, terminal_, nonterminal_); }
 
  private:
   RuleId rule_id_;
@@ -179,8 +208,12 @@ class NonTermTermNonTermProduction {
     }
   }
 
-  nonterm_type Create(IParserFactory<nonterm_type, term_type>& parser_factory) {
-    auto result = parser_factory.CreateNonTermTermNonTerm(rule_id_, lhs_, term_, rhs_);
+  template <typename TFactory>
+  nonterm_type Create(TFactory& parser_factory) { return Create(parser_factory, rule_id_); }
+
+  template <typename TFactory, typename TRuleId>
+  nonterm_type Create(TFactory& parser_factory, TRuleId rule_id) {
+    auto result = parser_factory.CreateNonTermTermNonTerm(rule_id, lhs_, term_, rhs_);
 
     return result;
   }
@@ -205,7 +238,11 @@ class NonTermTermNonTermSequenceProduction {
 
   void AddNonTerminal(nonterm_type const& nonterminal) { nonterms_.push_back(nonterminal); }
 
-  nonterm_type Create(IParserFactory<nonterm_type, term_type>& parser_factory) {
+  template <typename TFactory>
+  nonterm_type Create(TFactory& parser_factory) { return Create(parser_factory, rule_id_); }
+
+  template <typename TFactory, typename TRuleId>
+  nonterm_type Create(TFactory& parser_factory, TRuleId rule_id) {
     if (nonterms_.size() == 0) {
       return parser_factory.CreateNull();
     } else if (nonterms_.size() == 1) {
@@ -214,12 +251,12 @@ class NonTermTermNonTermSequenceProduction {
       auto lhs = nonterms_[0];
       auto rhs = nonterms_[1];
       auto term = terms_[0];
-      auto result = parser_factory.CreateNonTermTermNonTerm(rule_id_, lhs, term, rhs);
+      auto result = parser_factory.CreateNonTermTermNonTerm(rule_id, lhs, term, rhs);
       for (int i = 2; i < nonterms_.size(); i++) {
         lhs = result;
         rhs = nonterms_[i];
         term = terms_[i - 1];
-        result = parser_factory.CreateNonTermTermNonTerm(rule_id_, lhs, term, rhs);
+        result = parser_factory.CreateNonTermTermNonTerm(rule_id, lhs, term, rhs);
       }
 
       return result;
@@ -246,7 +283,11 @@ class NonTermListProduction {
 
   void AddNonTerminal(nonterm_type const& nonterminal) { nonterms_.push_back(nonterminal); }
 
-  nonterm_type Create(IParserFactory<nonterm_type, term_type>& parser_factory) { return parser_factory.CreateNonTermList(rule_id_, nonterms_); }
+  template <typename TFactory>
+  nonterm_type Create(TFactory& parser_factory) { return Create(parser_factory, rule_id_); }
+
+  template <typename TFactory, typename TRuleId>
+  nonterm_type Create(TFactory& parser_factory, TRuleId rule_id) { return parser_factory.CreateNonTermList(rule_id, nonterms_); }
 
  private:
   RuleId rule_id_;
@@ -267,7 +308,11 @@ class TermNonTermListProduction {
 
   void AddNonTerminal(nonterm_type const& nonterminal) { nonterms_.push_back(nonterminal); }
 
-  nonterm_type Create(IParserFactory<nonterm_type, term_type>& parser_factory) { return parser_factory.CreateTermNonTermList(rule_id_, terms_, nonterms_); }
+  template <typename TFactory>
+  nonterm_type Create(TFactory& parser_factory) { return Create(parser_factory, rule_id_); }
+
+  template <typename TFactory, typename TRuleId>
+  nonterm_type Create(TFactory& parser_factory, TRuleId rule_id) { return parser_factory.CreateTermNonTermList(rule_id, terms_, nonterms_); }
 
  private:
   RuleId rule_id_;
@@ -1,11 +1,19 @@
 #ifndef KOLIBRI_SRC_PARSER_RULES_H_
 #define KOLIBRI_SRC_PARSER_RULES_H_
 #include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
 
+#include <iterator>
+#include <array>
 #include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "parser/i_parser_factory.h"
+#include "parser/parser_productions.h"
 #include "parser/rule_id.h"
 
 namespace parser {
@@ -37,6 +45,62 @@ class IParserGrammar {
   virtual result_type Match(IParserFactory<nonterm_type, typename Iterator::value_type>& parser_factory, RuleId rule_id, Iterator& it, Iterator end) = 0;
 };
 
+// The token ids a rule or an expression can start with and whether it can match without consuming
+// a token. Token ids are only known for term predicates which define them as kId, any other
+// predicate can start with every token. Ids above 63 are treated the same way.
+struct FirstSet {
+  uint64_t ids;
+  bool any;
+  bool nullable;
+
+  constexpr bool Contains(unsigned id) const { return any || ((id < 64) && (((ids >> id) & 1) != 0)); }
+  constexpr bool operator==(const FirstSet& rhs) const { return (ids == rhs.ids) && (any == rhs.any) && (nullable == rhs.nullable); }
+  constexpr bool operator!=(const FirstSet& rhs) const { return !(*this == rhs); }
+};
+
+constexpr FirstSet kEmptyFirstSet = {0, false, false};
+
+// e1 | e2
+constexpr FirstSet FirstSetUnion(FirstSet lhs, FirstSet rhs) { return {lhs.ids | rhs.ids, lhs.any || rhs.any, lhs.nullable || rhs.nullable}; }
+
+// e1 e2
+constexpr FirstSet FirstSetSequence(FirstSet lhs, FirstSet rhs) {
+  if (!lhs.nullable) {
+    return lhs;
+  }
+  return {lhs.ids | rhs.ids, lhs.any || rhs.any, rhs.nullable};
+}
+
+// The FIRST set of an expression or a rule given the FIRST sets of all rules of the grammar. The
+// expressions of this file specialize it, anything else may start with any token or none.
+template <typename TExpression>
+struct FirstSetOf {
+  static constexpr FirstSet Get(const FirstSet* /*rules*/) { return {0, true, true}; }
+};
+
+// Grammars which derive from this tag have a MatchRule<RId>() method. Non terminals call the rule
+// through it directly instead of the virtual IParserGrammar::Match.
+class StaticDispatchGrammarTag {};
+
+template <typename TGrammar, typename = void>
+struct has_first_sets : std::false_type {};
+
+template <typename TGrammar>
+struct has_first_sets<TGrammar, std::void_t<decltype(TGrammar::kFirstSets)>> : std::true_type {};
+
+// False when the alternative can't match at it since the token can't start it. Only grammars with
+// FIRST sets are pruned. it must not be end.
+template <typename TAlternative, typename TGrammar, typename Iterator>
+bool CanStartWith(const Iterator& it) {
+  if constexpr (has_first_sets<TGrammar>::value) {
+    constexpr FirstSet first = FirstSetOf<TAlternative>::Get(TGrammar::kFirstSets.data());
+    if constexpr (!first.any && !first.nullable) {
+      return first.Contains(static_cast<unsigned>((*it).GetId()));
+    }
+  }
+  return true;
+}
+
 // ------------------------------------------------------------------------------------------------
 // RULES
 // ------------------------------------------------------------------------------------------------
@@ -44,9 +108,9 @@ class IParserGrammar {
 // This expression doesn't consume anything but returns a match
 class EmptyExpr {
  public:
-  template <typename Production, typename TNonTerm, typename Iterator>
-  Result Match(Production& production, IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory,
-               IParserGrammar<TNonTerm, Iterator>& parser_grammar, Iterator& it, Iterator end) {
+  template <typename Production, typename TFactory, typename Iterator, typename TGrammar>
+  Result Match(Production& production, TFactory& parser_factory,
+               TGrammar& parser_grammar, Iterator& it, Iterator end) {
     auto result = Result(true, false, "");
     return result;
   };
@@ -56,9 +120,9 @@ class EmptyExpr {
 template <typename TermPredicate>
 class TermExpr {
  public:
-  template <typename Production, typename TNonTerm, typename Iterator>
-  Result Match(Production& production, IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory,
-               IParserGrammar<TNonTerm, Iterator>& parser_grammar, Iterator& it, Iterator end) {
+  template <typename Production, typename TFactory, typename Iterator, typename TGrammar>
+  Result Match(Production& production, TFactory& parser_factory,
+               TGrammar& parser_grammar, Iterator& it, Iterator end) {
     if (it == end) {
       auto result = Result(false, false, "TermExpr: No match");
       return result;
@@ -83,14 +147,14 @@ class TermExpr {
 template <RuleId RId>
 class NonTermExpr {
  public:
-  template <typename Production, typename TNonTerm, typename Iterator>
-  Result Match(Production& production, IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory,
-               IParserGrammar<TNonTerm, Iterator>& parser_grammar, Iterator& it, Iterator end) {
+  template <typename Production, typename TFactory, typename Iterator, typename TGrammar>
+  Result Match(Production& production, TFactory& parser_factory,
+               TGrammar& parser_grammar, Iterator& it, Iterator end) {
     if (it == end) {
       auto result = Result(false, false, "NonTermExpr: No match");
       return result;
     }
-    auto terminal_result = parser_grammar.Match(parser_factory, RId, it, end);
+    auto terminal_result = MatchRule(parser_factory, parser_grammar, it, end);
     if (terminal_result.is_error) {
       auto result = Result(false, true, terminal_result.msg);
       return result;
@@ -104,28 +168,42 @@ class NonTermExpr {
     auto result = Result(true, false, "");
     return result;
   };
+
+ private:
+  template <typename TFactory, typename Iterator, typename TGrammar>
+  static RuleResult<typename TFactory::nonterm_type> MatchRule(TFactory& parser_factory, TGrammar& parser_grammar, Iterator& it,
+                                        Iterator end) {
+    if constexpr (std::is_base_of<StaticDispatchGrammarTag, TGrammar>::value) {
+      return parser_grammar.template MatchRule<RId>(parser_factory, it, end);
+    } else {
+      return parser_grammar.Match(parser_factory, RId, it, end);
+    }
+  }
 };
 
 // e1 | e2 | ... | en
 template <typename... Expressions>
 class OrderedChoiceExpr {
  public:
-  template <typename Production, typename TNonTerm, typename Iterator>
-  Result Match(Production& production, IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory,
-               IParserGrammar<TNonTerm, Iterator>& parser_grammar, Iterator& it, Iterator end) {
+  template <typename Production, typename TFactory, typename Iterator, typename TGrammar>
+  Result Match(Production& production, TFactory& parser_factory,
+               TGrammar& parser_grammar, Iterator& it, Iterator end) {
     if (it == end) {
       auto result = Result(false, false, "OrderedChoiceExpr: No match");
       return result;
     }
 
-    auto result = MatchRecursive<0, Production, TNonTerm, Iterator, Expressions...>(production, parser_factory, parser_grammar, it, end);
+    auto result = MatchRecursive<0, Production, TFactory, Iterator, Expressions...>(production, parser_factory, parser_grammar, it, end);
     return result;
   };
 
  private:
-  template <unsigned Idx, typename Production, typename TNonTerm, typename Iterator, typename T1>
-  Result MatchRecursive(Production& production, IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory,
-                        IParserGrammar<TNonTerm, Iterator>& parser_grammar, Iterator& it, Iterator end) {
+  template <unsigned Idx, typename Production, typename TFactory, typename Iterator, typename T1, typename TGrammar>
+  Result MatchRecursive(Production& production, TFactory& parser_factory,
+                        TGrammar& parser_grammar, Iterator& it, Iterator end) {
+    if (!CanStartWith<T1, TGrammar>(it)) {
+      return Result(false, false, "OrderedChoiceExpr: No match");
+    }
     T1 expression;
     auto result = expression.Match(production, parser_factory, parser_grammar, it, end);
     if (result.is_match) {
@@ -138,9 +216,12 @@ class OrderedChoiceExpr {
     return result;
   }
 
-  template <unsigned Idx, typename Production, typename TNonTerm, typename Iterator, typename T1, typename T2, typename... Args>
-  Result MatchRecursive(Production& production, IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory,
-                        IParserGrammar<TNonTerm, Iterator>& parser_grammar, Iterator& it, Iterator end) {
+  template <unsigned Idx, typename Production, typename TFactory, typename Iterator, typename T1, typename T2, typename... Args, typename TGrammar>
+  Result MatchRecursive(Production& production, TFactory& parser_factory,
+                        TGrammar& parser_grammar, Iterator& it, Iterator end) {
+    if (!CanStartWith<T1, TGrammar>(it)) {
+      return MatchRecursive<Idx + 1, Production, TFactory, Iterator, T2, Args...>(production, parser_factory, parser_grammar, it, end);
+    }
     T1 expression;
     auto result = expression.Match(production, parser_factory, parser_grammar, it, end);
     if (result.is_match) {
@@ -150,7 +231,7 @@ class OrderedChoiceExpr {
       return result;
     }
 
-    return MatchRecursive<Idx + 1, Production, TNonTerm, Iterator, T2, Args...>(production, parser_factory, parser_grammar, it, end);
+    return MatchRecursive<Idx + 1, Production, TFactory, Iterator, T2, Args...>(production, parser_factory, parser_grammar, it, end);
   }
 };
 
@@ -158,9 +239,9 @@ class OrderedChoiceExpr {
 template <typename Expression>
 class OptionalExpr {
  public:
-  template <typename Production, typename TNonTerm, typename Iterator>
-  Result Match(Production& production, IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory,
-               IParserGrammar<TNonTerm, Iterator>& parser_grammar, Iterator& it, Iterator end) {
+  template <typename Production, typename TFactory, typename Iterator, typename TGrammar>
+  Result Match(Production& production, TFactory& parser_factory,
+               TGrammar& parser_grammar, Iterator& it, Iterator end) {
     if (it == end) {
       auto result = Result(true, false, "");
       return result;
@@ -180,9 +261,9 @@ class OptionalExpr {
 template <unsigned N, typename Expression>
 class NMatchesOrMoreExpr {
  public:
-  template <typename Production, typename TNonTerm, typename Iterator>
-  Result Match(Production& production, IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory,
-               IParserGrammar<TNonTerm, Iterator>& parser_grammar, Iterator& it, Iterator end) {
+  template <typename Production, typename TFactory, typename Iterator, typename TGrammar>
+  Result Match(Production& production, TFactory& parser_factory,
+               TGrammar& parser_grammar, Iterator& it, Iterator end) {
     for (unsigned i = 0; i < N; ++i) {
       if (it == end) {
         return Result(false, false, "NMatchesOrMoreExpr: No match");
@@ -222,11 +303,11 @@ class SequenceExpr {
  public:
   SequenceExpr() {}
 
-  template <typename Production, typename TNonTerm, typename Iterator>
-  Result Match(Production& production, IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory,
-               IParserGrammar<TNonTerm, Iterator>& parser_grammar, Iterator& it, Iterator end) {
+  template <typename Production, typename TFactory, typename Iterator, typename TGrammar>
+  Result Match(Production& production, TFactory& parser_factory,
+               TGrammar& parser_grammar, Iterator& it, Iterator end) {
     auto backup_it = it;
-    auto result = MatchRulesRecursive<Production, TNonTerm, Iterator, Expressions...>(production, parser_factory, parser_grammar, it, end);
+    auto result = MatchRulesRecursive<Production, TFactory, Iterator, Expressions...>(production, parser_factory, parser_grammar, it, end);
     if (!result.is_match) {
       it = backup_it;
     }
@@ -234,9 +315,9 @@ class SequenceExpr {
   };
 
  private:
-  template <typename Production, typename TNonTerm, typename Iterator, typename T1>
-  Result MatchRulesRecursive(Production& production, IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory,
-                             IParserGrammar<TNonTerm, Iterator>& parser_grammar, Iterator& it, Iterator end) {
+  template <typename Production, typename TFactory, typename Iterator, typename T1, typename TGrammar>
+  Result MatchRulesRecursive(Production& production, TFactory& parser_factory,
+                             TGrammar& parser_grammar, Iterator& it, Iterator end) {
     T1 t1;
     auto res = t1.Match(production, parser_factory, parser_grammar, it, end);
 
@@ -250,9 +331,9 @@ class SequenceExpr {
     return Result(true, false, "");
   }
 
-  template <typename Production, typename TNonTerm, typename Iterator, typename T1, typename T2, typename... Expr>
-  Result MatchRulesRecursive(Production& production, IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory,
-                             IParserGrammar<TNonTerm, Iterator>& parser_grammar, Iterator& it, Iterator end) {
+  template <typename Production, typename TFactory, typename Iterator, typename T1, typename T2, typename... Expr, typename TGrammar>
+  Result MatchRulesRecursive(Production& production, TFactory& parser_factory,
+                             TGrammar& parser_grammar, Iterator& it, Iterator end) {
     T1 t1;
     auto res = t1.Match(production, parser_factory, parser_grammar, it, end);
 
@@ -263,40 +344,171 @@ class SequenceExpr {
       return res;
     }
 
-    auto result = MatchRulesRecursive<Production, TNonTerm, Iterator, T2, Expr...>(production, parser_factory, parser_grammar, it, end);
+    auto result = MatchRulesRecursive<Production, TFactory, Iterator, T2, Expr...>(production, parser_factory, parser_grammar, it, end);
     return result;
   }
 };
 
+enum class Associativity { kLeft, kRight };
+
+constexpr unsigned kMaxOperatorTokenId = 64;
+
+// An operator of a PrecedenceExpr. Operators with a higher precedence bind stronger, the lowest
+// precedence is 1. The node of an operation is created by CreateNonTermTermNonTerm() with RId, the
+// term predicate has to define its token id as kId.
+template <RuleId RId, typename TermPredicate, unsigned Precedence, Associativity Assoc = Associativity::kLeft>
+struct BinaryOperator {
+  static_assert(Precedence > 0, "BinaryOperator: the lowest precedence is 1");
+  static_assert(static_cast<unsigned>(TermPredicate::kId) < kMaxOperatorTokenId, "BinaryOperator: token id out of range");
+
+  static constexpr RuleId kRuleId = RId;
+  static constexpr unsigned kTokenId = static_cast<unsigned>(TermPredicate::kId);
+  static constexpr unsigned kPrecedence = Precedence;
+  static constexpr bool kRightAssociative = Assoc == Associativity::kRight;
+};
+
+struct OperatorInfo {
+  unsigned precedence;  // 0 if the token isn't an operator
+  bool right_associative;
+  RuleId rule_id;
+};
+
+// operand (op operand)* where the operands are combined by the precedence and the associativity of
+// the operators (precedence climbing). One expression parses the operators of all levels, which
+// would take a rule per level otherwise, e.g. for
+//
+//   expr : term ((PLUS | MINUS) term)*
+//   term : factor ((MUL | DIV) factor)*
+//
+// PrecedenceExpr<factor, BinaryOperator<kExpr, PLUS, 1>, BinaryOperator<kExpr, MINUS, 1>,
+// BinaryOperator<kTerm, MUL, 2>, BinaryOperator<kTerm, DIV, 2>> creates the same nodes. The operand
+// has to add a single non terminal to its production. An operator which isn't followed by an
+// operand isn't consumed. The resulting node is added to the production of the rule.
+template <typename Operand, typename... Operators>
+class PrecedenceExpr {
+ public:
+  static constexpr std::array<OperatorInfo, kMaxOperatorTokenId> MakeOperatorTable() {
+    std::array<OperatorInfo, kMaxOperatorTokenId> table{};
+    ((table[Operators::kTokenId] = {Operators::kPrecedence, Operators::kRightAssociative, Operators::kRuleId}), ...);
+    return table;
+  }
+
+  static constexpr std::array<OperatorInfo, kMaxOperatorTokenId> kOperators = MakeOperatorTable();
+
+  template <typename Production, typename TFactory, typename Iterator, typename TGrammar>
+  Result Match(Production& production, TFactory& parser_factory, TGrammar& parser_grammar, Iterator& it, Iterator end) {
+    typename TFactory::nonterm_type node{};
+    auto result = MatchPrecedence(1, node, parser_factory, parser_grammar, it, end);
+    if (result.is_match) {
+      production.AddNonTerminal(node);
+    }
+    return result;
+  };
+
+ private:
+  template <typename Token>
+  static OperatorInfo FindOperator(const Token& token) {
+    auto id = static_cast<unsigned>(token.GetId());
+    return id < kMaxOperatorTokenId ? kOperators[id] : OperatorInfo{0, false, RuleId::kRule0};
+  }
+
+  // operand (op operand)* for all operators with at least min_precedence
+  template <typename TFactory, typename Iterator, typename TGrammar>
+  Result MatchPrecedence(unsigned min_precedence, typename TFactory::nonterm_type& node, TFactory& parser_factory, TGrammar& parser_grammar,
+                         Iterator& it, Iterator end) {
+    auto result = MatchOperand(node, parser_factory, parser_grammar, it, end);
+    if (!result.is_match || result.is_error) {
+      return result;
+    }
+
+    while (it != end) {
+      OperatorInfo info = FindOperator(*it);
+      if (info.precedence < min_precedence) {
+        break;
+      }
+      auto operator_it = it;
+      auto token = *it;
+      ++it;
+
+      // like a failed (op operand) sequence of a repetition the operator is left to the caller
+      typename TFactory::nonterm_type rhs{};
+      result = MatchPrecedence(info.right_associative ? info.precedence : info.precedence + 1, rhs, parser_factory, parser_grammar, it, end);
+      if (!result.is_match) {
+        it = operator_it;
+        break;
+      }
+      if (result.is_error) {
+        return result;
+      }
+      node = CreateOperation(info.rule_id, parser_factory, node, token, rhs);
+    }
+    return Result(true, false, "");
+  }
+
+  template <typename TFactory, typename Iterator, typename TGrammar>
+  Result MatchOperand(typename TFactory::nonterm_type& node, TFactory& parser_factory, TGrammar& parser_grammar, Iterator& it, Iterator end) {
+    if (it == end) {
+      return Result(false, false, "PrecedenceExpr: No match");
+    }
+    BypassLastTermProduction<typename TFactory::nonterm_type, typename Iterator::value_type> operand_production(RuleId::kRule0);
+    Operand operand;
+    auto backup_it = it;
+    auto result = operand.Match(operand_production, parser_factory, parser_grammar, it, end);
+    if (!result.is_match) {
+      it = backup_it;
+      return result;
+    }
+    node = operand_production.Create(parser_factory);
+    return result;
+  }
+
+  // The rule id of the operator is passed as RuleIdConstant.
+  template <typename TFactory, typename TTerm>
+  static typename TFactory::nonterm_type CreateOperation(RuleId rule_id, TFactory& parser_factory, const typename TFactory::nonterm_type& lhs,
+                                                         const TTerm& term, const typename TFactory::nonterm_type& rhs) {
+    typename TFactory::nonterm_type node{};
+    ((rule_id == Operators::kRuleId && (node = parser_factory.CreateNonTermTermNonTerm(RuleIdConstant<Operators::kRuleId>(), lhs, term, rhs), true)) || ...);
+    return node;
+  }
+};
+
+// The rule id passed to Match() may be a RuleIdConstant, it is handed on to the factory through the
+// production. Without one the rule id of the constructor is used.
 template <template <class, class> class Production, typename Expression>
 class Rule {
  public:
   Rule(RuleId rule_id) : rule_id_(rule_id) {}
 
-  template <typename TNonTerm, typename Iterator>
-  RuleResult<TNonTerm> Match(IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory, IParserGrammar<TNonTerm, Iterator>& parser_grammar,
-                             Iterator& it, Iterator end) {
+  template <typename TFactory, typename Iterator, typename TGrammar>
+  RuleResult<typename TFactory::nonterm_type> Match(TFactory& parser_factory, TGrammar& parser_grammar, Iterator& it, Iterator end) {
+    return Match(parser_factory, parser_grammar, it, end, rule_id_);
+  }
+
+  template <typename TFactory, typename Iterator, typename TGrammar, typename TRuleId>
+  RuleResult<typename TFactory::nonterm_type> Match(TFactory& parser_factory, TGrammar& parser_grammar, Iterator& it, Iterator end,
+                                                    TRuleId rule_id) {
+    using result_type = RuleResult<typename TFactory::nonterm_type>;
     auto backup_it = it;
 
     if (it == end) {
-      return RuleResult<TNonTerm>(false, parser_factory.CreateNull(), false, "Rule -  No match");
+      return result_type(false, parser_factory.CreateNull(), false, "Rule -  No match");
     }
 
-    Production<TNonTerm, typename Iterator::value_type> production(rule_id_);
+    Production<typename TFactory::nonterm_type, typename Iterator::value_type> production(rule_id);
     Expression expr;
     auto res = expr.Match(production, parser_factory, parser_grammar, it, end);
 
     if (!res.is_match) {
       it = backup_it;
-      return RuleResult<TNonTerm>(false, parser_factory.CreateNull(), false, "Rule -  No match");
+      return result_type(false, parser_factory.CreateNull(), false, "Rule -  No match");
     }
     if (res.is_error) {
-      return RuleResult<TNonTerm>(false, parser_factory.CreateNull(), true, res.msg);
+      return result_type(false, parser_factory.CreateNull(), true, res.msg);
     }
 
     // perform production
-    auto node = production.Create(parser_factory);
-    return RuleResult<TNonTerm>(true, node, false, "");
+    auto node = production.Create(parser_factory, rule_id);
+    return result_type(true, node, false, "");
   };
 
  private:
@@ -308,90 +520,285 @@ class OrderedChoiceRules {
  public:
   OrderedChoiceRules(RuleId rule_id) : rule_id_(rule_id) {}
 
-  template <typename TNonTerm, typename Iterator>
-  RuleResult<TNonTerm> Match(IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory, IParserGrammar<TNonTerm, Iterator>& parser_grammar,
-                             Iterator& it, Iterator end) {
+  template <typename TFactory, typename Iterator, typename TGrammar>
+  RuleResult<typename TFactory::nonterm_type> Match(TFactory& parser_factory, TGrammar& parser_grammar, Iterator& it, Iterator end) {
+    return Match(parser_factory, parser_grammar, it, end, rule_id_);
+  }
+
+  template <typename TFactory, typename Iterator, typename TGrammar, typename TRuleId>
+  RuleResult<typename TFactory::nonterm_type> Match(TFactory& parser_factory, TGrammar& parser_grammar, Iterator& it, Iterator end,
+                                                    TRuleId rule_id) {
     if (it == end) {
-      auto result = RuleResult<TNonTerm>(false, parser_factory.CreateNull(), true, "ERROR: Unexpected END");
+      auto result = RuleResult<typename TFactory::nonterm_type>(false, parser_factory.CreateNull(), true, "ERROR: Unexpected END");
       return result;
     }
-    return MatchRulesRecursive<TNonTerm, Iterator, Args...>(parser_factory, parser_grammar, it, end);
+    return MatchRulesRecursive<TFactory, Iterator, Args...>(parser_factory, parser_grammar, it, end, rule_id);
   };
 
  private:
-  template <typename TNonTerm, typename Iterator, typename T1>
-  RuleResult<TNonTerm> MatchRulesRecursive(IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory,
-                                           IParserGrammar<TNonTerm, Iterator>& parser_grammar, Iterator& it, Iterator end) {
-    T1 t1(rule_id_);
-    auto res = t1.Match(parser_factory, parser_grammar, it, end);
+  template <typename TFactory, typename Iterator, typename T1, typename TGrammar, typename TRuleId>
+  RuleResult<typename TFactory::nonterm_type> MatchRulesRecursive(TFactory& parser_factory, TGrammar& parser_grammar, Iterator& it, Iterator end,
+                                                                  TRuleId rule_id) {
+    if (!CanStartWith<T1, TGrammar>(it)) {
+      return RuleResult<typename TFactory::nonterm_type>(false, parser_factory.CreateNull(), false, "OrderedChoiceRule -  No match");
+    }
+    T1 t1(rule_id);
+    auto res = t1.Match(parser_factory, parser_grammar, it, end, rule_id);
     if (res.is_match) {
       return res;
     }
     if (res.is_error) {
       return res;
     }
-    return RuleResult<TNonTerm>(false, parser_factory.CreateNull(), false, "OrderedChoiceRule -  No match");
+    return RuleResult<typename TFactory::nonterm_type>(false, parser_factory.CreateNull(), false, "OrderedChoiceRule -  No match");
   }
 
-  template <typename TNonTerm, typename Iterator, typename T1, typename T2, typename... Rules>
-  RuleResult<TNonTerm> MatchRulesRecursive(IParserFactory<TNonTerm, typename Iterator::value_type>& parser_factory,
-                                           IParserGrammar<TNonTerm, Iterator>& parser_grammar, Iterator& it, Iterator end) {
-    T1 t1(rule_id_);
+  template <typename TFactory, typename Iterator, typename T1, typename T2, typename... Rules, typename TGrammar, typename TRuleId>
+  RuleResult<typename TFactory::nonterm_type> MatchRulesRecursive(TFactory& parser_factory, TGrammar& parser_grammar, Iterator& it, Iterator end,
+                                                                  TRuleId rule_id) {
+    if (!CanStartWith<T1, TGrammar>(it)) {
+      return MatchRulesRecursive<TFactory, Iterator, T2, Rules...>(parser_factory, parser_grammar, it, end, rule_id);
+    }
+    T1 t1(rule_id);
 
-    auto res = t1.Match(parser_factory, parser_grammar, it, end);
+    auto res = t1.Match(parser_factory, parser_grammar, it, end, rule_id);
     if (res.is_match) {
       return res;
     }
     if (res.is_error) {
       return res;
     }
-    return MatchRulesRecursive<TNonTerm, Iterator, T2, Rules...>(parser_factory, parser_grammar, it, end);
+    return MatchRulesRecursive<TFactory, Iterator, T2, Rules...>(parser_factory, parser_grammar, it, end, rule_id);
   }
 
  private:
   RuleId rule_id_;
 };
 
+// ------------------------------------------------------------------------------------------------
+// FIRST SETS
+// ------------------------------------------------------------------------------------------------
+
+template <typename TermPredicate, typename = void>
+struct term_predicate_first_set {
+  static constexpr FirstSet kFirstSet = {0, true, false};
+};
+
+template <typename TermPredicate>
+struct term_predicate_first_set<TermPredicate, std::void_t<decltype(TermPredicate::kId)>> {
+  static constexpr unsigned kIdValue = static_cast<unsigned>(TermPredicate::kId);
+  static constexpr FirstSet kFirstSet = kIdValue < 64 ? FirstSet{uint64_t{1} << kIdValue, false, false} : FirstSet{0, true, false};
+};
+
+template <>
+struct FirstSetOf<EmptyExpr> {
+  static constexpr FirstSet Get(const FirstSet* /*rules*/) { return {0, false, true}; }
+};
+
+template <typename TermPredicate>
+struct FirstSetOf<TermExpr<TermPredicate>> {
+  static constexpr FirstSet Get(const FirstSet* /*rules*/) { return term_predicate_first_set<TermPredicate>::kFirstSet; }
+};
+
+template <RuleId RId>
+struct FirstSetOf<NonTermExpr<RId>> {
+  static constexpr FirstSet Get(const FirstSet* rules) { return rules[static_cast<size_t>(RId)]; }
+};
+
+template <typename... Expressions>
+struct FirstSetOf<OrderedChoiceExpr<Expressions...>> {
+  static constexpr FirstSet Get(const FirstSet* rules) {
+    FirstSet first = kEmptyFirstSet;
+    ((first = FirstSetUnion(first, FirstSetOf<Expressions>::Get(rules))), ...);
+    return first;
+  }
+};
+
+template <typename Expression>
+struct FirstSetOf<OptionalExpr<Expression>> {
+  static constexpr FirstSet Get(const FirstSet* rules) {
+    FirstSet first = FirstSetOf<Expression>::Get(rules);
+    first.nullable = true;
+    return first;
+  }
+};
+
+template <unsigned N, typename Expression>
+struct FirstSetOf<NMatchesOrMoreExpr<N, Expression>> {
+  static constexpr FirstSet Get(const FirstSet* rules) {
+    FirstSet first = FirstSetOf<Expression>::Get(rules);
+    first.nullable = first.nullable || (N == 0);
+    return first;
+  }
+};
+
+template <typename... Expressions>
+struct FirstSetOf<SequenceExpr<Expressions...>> {
+  static constexpr FirstSet Get(const FirstSet* rules) {
+    FirstSet first = {0, false, true};
+    ((first = FirstSetSequence(first, FirstSetOf<Expressions>::Get(rules))), ...);
+    return first;
+  }
+};
+
+template <typename Operand, typename... Operators>
+struct FirstSetOf<PrecedenceExpr<Operand, Operators...>> {
+  static constexpr FirstSet Get(const FirstSet* rules) { return FirstSetOf<Operand>::Get(rules); }
+};
+
+template <template <class, class> class Production, typename Expression>
+struct FirstSetOf<Rule<Production, Expression>> {
+  static constexpr FirstSet Get(const FirstSet* rules) { return FirstSetOf<Expression>::Get(rules); }
+};
+
+template <typename... Args>
+struct FirstSetOf<OrderedChoiceRules<Args...>> {
+  static constexpr FirstSet Get(const FirstSet* rules) {
+    FirstSet first = kEmptyFirstSet;
+    ((first = FirstSetUnion(first, FirstSetOf<Args>::Get(rules))), ...);
+    return first;
+  }
+};
+
+// The FIRST sets of all rules of a grammar. Starts with empty sets and applies the rules until
+// nothing changes anymore, which handles recursive rules.
+template <typename... Rules>
+constexpr std::array<FirstSet, sizeof...(Rules)> MakeFirstSets() {
+  std::array<FirstSet, sizeof...(Rules)> sets{};
+  bool changed = true;
+  while (changed) {
+    std::array<FirstSet, sizeof...(Rules)> next = {FirstSetOf<Rules>::Get(sets.data())...};
+    changed = false;
+    for (size_t i = 0; i < sets.size(); ++i) {
+      changed = changed || (next[i] != sets[i]);
+      sets[i] = next[i];
+    }
+  }
+  return sets;
+}
+
 // ------------------------------------------------------------------------------------------------
 // GRAMMAR
 // ------------------------------------------------------------------------------------------------
 
-template <typename TNonTerm, typename Iterator, typename... Terminals>
-class ParserGrammar : public IParserGrammar<TNonTerm, Iterator> {
+// The rules of a grammar are called by their index. Non terminals call MatchRule<RId>(), which
+// constructs the rule type at index RId of the pack directly. The virtual Match() is kept for
+// callers which only know the rule id at runtime, it dispatches through a table of MatchRule<>()
+// instantiations with the IParserFactory interface. MatchRule<>() takes any factory, which is
+// called statically, and passes the rule id as RuleIdConstant to it.
+//
+// With Memoize the result of every rule is remembered per token position (packrat parsing), so a
+// rule which is retried at the same position after an ordered choice backtracked isn't parsed
+// again and the parse time stays linear in the number of tokens. The remembered results are
+// dropped by Reset() which has to be called before each new input. Memoization needs random
+// access iterators and copyable nodes.
+template <bool Memoize, typename TNonTerm, typename Iterator, typename... Terminals>
+class BasicParserGrammar : public IParserGrammar<TNonTerm, Iterator>, public StaticDispatchGrammarTag {
  public:
   using nonterm_type = TNonTerm;
   using iterator_type = Iterator;
   using term_type = typename iterator_type::value_type;
   using result_type = RuleResult<nonterm_type>;  // Use value type of first factory
+  using factory_interface = IParserFactory<nonterm_type, term_type>;
+
+  BasicParserGrammar() : memo_() {}
+  result_type Match(factory_interface& parser_factory, RuleId rule_id, iterator_type& it, iterator_type end) override {
+    assert(static_cast<size_t>(rule_id) < kNumRules);
+    return (this->*kDispatch.functions[static_cast<size_t>(rule_id)])(parser_factory, it, end);
+  };
 
-  ParserGrammar() {}
-  result_type Match(IParserFactory<nonterm_type, term_type>& parser_factory, RuleId rule_id, iterator_type& it, iterator_type end) override {
+  template <RuleId RId, typename TFactory>
+  result_type MatchRule(TFactory& parser_factory, iterator_type& it, iterator_type end) {
+    static_assert(static_cast<size_t>(RId) < sizeof...(Terminals), "BasicParserGrammar: rule id out of range");
     if (it == end) {
       auto result = result_type(false, parser_factory.CreateNull(), true, "ERROR: Unexpected END");
       return result;
     }
 
-    return CallRule<0, Terminals...>(parser_factory, rule_id, it, end);
+    if constexpr (Memoize) {
+      return MatchMemoized<RId, TFactory>(parser_factory, it, end);
+    } else {
+      return CallRule<RId, TFactory>(parser_factory, it, end);
+    }
+  }
+
+  void Reset() { memo_.clear(); }
+
+  // Used to skip the alternatives of a choice which can't start with the next token.
+  static constexpr std::array<FirstSet, sizeof...(Terminals)> kFirstSets = MakeFirstSets<Terminals...>();
+
+ private:
+  static constexpr size_t kNumRules = sizeof...(Terminals);
+
+  using match_function = result_type (BasicParserGrammar::*)(factory_interface&, iterator_type&, iterator_type);
+
+  struct DispatchTable {
+    match_function functions[kNumRules];
   };
 
-  template <unsigned Idx, typename T1>
-  result_type CallRule(IParserFactory<nonterm_type, term_type>& parser_factory, RuleId rule_id, iterator_type& it, iterator_type end) {
-    assert(static_cast<unsigned>(rule_id) == Idx);
-    T1 t1(rule_id);
+  template <size_t... Indices>
+  static constexpr DispatchTable MakeDispatchTable(std::index_sequence<Indices...>) {
+    return DispatchTable{{&BasicParserGrammar::template MatchRule<static_cast<RuleId>(Indices), factory_interface>...}};
+  }
+
+  static constexpr DispatchTable kDispatch = MakeDispatchTable(std::make_index_sequence<kNumRules>());
 
-    return t1.Match(parser_factory, *this, it, end);  // assume last rule does match every time
+  template <RuleId RId, typename TFactory>
+  result_type CallRule(TFactory& parser_factory, iterator_type& it, iterator_type end) {
+    using rule_type = std::tuple_element_t<static_cast<size_t>(RId), std::tuple<Terminals...>>;
+    rule_type rule(RId);
+    return rule.Match(parser_factory, *this, it, end, RuleIdConstant<RId>());
   }
 
-  template <unsigned Idx, typename T1, typename T2, typename... Rest>
-  result_type CallRule(IParserFactory<nonterm_type, term_type>& parser_factory, RuleId rule_id, iterator_type& it, iterator_type end) {
-    if (static_cast<unsigned>(rule_id) == Idx) {
-      T1 t1(rule_id);
-      return t1.Match(parser_factory, *this, it, end);
+  struct MemoEntry {
+    bool is_known = false;
+    bool is_match = false;
+    bool is_error = false;
+    const char* msg = nullptr;
+    nonterm_type node{};
+    size_t remaining = 0;  // tokens left behind the match
+  };
+
+  // The position of a token is its distance to end, which doesn't change while the input is parsed.
+  template <RuleId RId, typename TFactory>
+  result_type MatchMemoized(TFactory& parser_factory, iterator_type& it, iterator_type end) {
+    static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<iterator_type>::iterator_category>::value,
+                  "BasicParserGrammar: memoization requires random access iterators");
+
+    size_t remaining = static_cast<size_t>(end - it);
+    size_t index = remaining * kNumRules + static_cast<size_t>(RId);
+    if (index >= memo_.size()) {
+      memo_.resize((remaining + 1) * kNumRules);
+    }
+
+    if (!memo_[index].is_known) {
+      auto result = CallRule<RId, TFactory>(parser_factory, it, end);
+      // memo_ may have been resized by the nested rules
+      MemoEntry& entry = memo_[index];
+      entry.is_known = true;
+      entry.is_match = result.is_match;
+      entry.is_error = result.is_error;
+      entry.msg = result.msg;
+      entry.node = result.node;
+      entry.remaining = static_cast<size_t>(end - it);
+      return result;
     }
-    return CallRule<Idx + 1, T2, Rest...>(parser_factory, rule_id, it, end);
+
+    const MemoEntry& entry = memo_[index];
+    it = end - static_cast<ptrdiff_t>(entry.remaining);
+    return result_type(entry.is_match, entry.node, entry.is_error, entry.msg);
   }
+
+  std::vector<MemoEntry> memo_;  // kNumRules entries per token position
 };
 
+template <typename TNonTerm, typename Iterator, typename... Terminals>
+class ParserGrammar : public BasicParserGrammar<false, TNonTerm, Iterator, Terminals...> {};
+
+// Packrat parser. See BasicParserGrammar.
+template <typename TNonTerm, typename Iterator, typename... Terminals>
+class PackratParserGrammar : public BasicParserGrammar<true, TNonTerm, Iterator, Terminals...> {};
+
 struct GrammarBase {
   template <template <class, class> class Production, typename Expression>
   using Rule = parser::Rule<Production, Expression>;
@@ -415,6 +822,12 @@ struct GrammarBase {
 
   template <typename... Args>
   using OrderedChoiceRules = parser::OrderedChoiceRules<Args...>;
+
+  template <typename Operand, typename... Operators>
+  using PrecedenceExpr = parser::PrecedenceExpr<Operand, Operators...>;
+
+  template <RuleId RId, typename TermPredicate, unsigned Precedence, Associativity Assoc = Associativity::kLeft>
+  using BinaryOperator = parser::BinaryOperator<RId, TermPredicate, Precedence, Assoc>;
 };
 
 }  // namespace parser
@@ -1,6 +1,8 @@
 #ifndef KOLIBRI_SRC_RULE_ID_H_
 #define KOLIBRI_SRC_RULE_ID_H_
 
+#include <type_traits>
+
 namespace parser {
 enum class RuleId {
   kRule0 = 0,
@@ -19,6 +21,11 @@ enum class RuleId {
   kRule13 = 13,
   kRule14 = 14
 };
+
+// A rule id which is known at compile time. It converts to RuleId, factories with templated Create
+// methods get the id as part of the type instead.
+template <RuleId RId>
+using RuleIdConstant = std::integral_constant<RuleId, RId>;
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "base/line_index.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "base/source_manager.h"
+
+using namespace base;
+using namespace std;
+
+TEST(LineIndexTest, LocateOffsets) {
+  string source = "ab\ncd\n\nefg";
+  LineIndex index(source);
+  EXPECT_EQ(index.NumLines(), 4u);
+
+  auto location = index.Locate(size_t{0});
+  EXPECT_EQ(location.line, 1u);
+  EXPECT_EQ(location.column, 1u);
+
+  location = index.Locate(size_t{2});  // the line break belongs to its line
+  EXPECT_EQ(location.line, 1u);
+  EXPECT_EQ(location.column, 3u);
+
+  location = index.Locate(size_t{4});
+  EXPECT_EQ(location.line, 2u);
+  EXPECT_EQ(location.column, 2u);
+
+  location = index.Locate(size_t{6});
+  EXPECT_EQ(location.line, 3u);
+  EXPECT_EQ(location.column, 1u);
+
+  location = index.Locate(source.size());
+  EXPECT_EQ(location.line, 4u);
+  EXPECT_EQ(location.column, 4u);
+}
+
+TEST(LineIndexTest, LocatePointers) {
+  string source = "PROGRAM x;\nBEGIN\n  a := 1\nEND.";
+  LineIndex index(source);
+  auto location = index.Locate(source.data() + source.find("a :="));
+  EXPECT_EQ(location.line, 3u);
+  EXPECT_EQ(location.column, 3u);
+}
+
+TEST(LineIndexTest, GetLine) {
+  string source = "first\nsecond\n";
+  LineIndex index(source);
+  EXPECT_EQ(index.GetLine(1), "first");
+  EXPECT_EQ(index.GetLine(2), "second");
+  EXPECT_EQ(index.GetLine(3), "");
+  EXPECT_EQ(index.GetLine(4), "");
+}
+
+TEST(LineIndexTest, LongLinesAreScannedVectorized) {
+  string source = string(1000, 'x') + "\n" + string(77, 'y') + "\n" + string(40, 'z');
+  LineIndex index(source);
+  EXPECT_EQ(index.NumLines(), 3u);
+  auto location = index.Locate(source.data() + 1000 + 1 + 77 + 1 + 39);
+  EXPECT_EQ(location.line, 3u);
+  EXPECT_EQ(location.column, 40u);
+}
+
+TEST(LineIndexTest, Format) {
+  string source = "a\nbc";
+  LineIndex index(source);
+  EXPECT_EQ(index.Format("main.pas", source.data() + 3, "ERROR: Tokens left"), "main.pas:2:2: ERROR: Tokens left");
+  EXPECT_EQ(index.Format("main.pas", nullptr, "ERROR: Unexpected END"), "main.pas: ERROR: Unexpected END");
+}
+
+TEST(LineIndexTest, SourceBufferLineIndex) {
+  SourceManager manager;
+  auto buffer = manager.AddString("test", "x\ny");
+  auto location = buffer->GetLineIndex().Locate(buffer->begin() + 2);
+  EXPECT_EQ(location.line, 2u);
+  EXPECT_EQ(location.column, 1u);
+}
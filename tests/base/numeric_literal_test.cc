@@ -0,0 +1,50 @@
+#include "base/numeric_literal.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace base;
+using namespace std;
+
+TEST(NumericLiteralTest, ParseInteger) {
+  int64_t value = 0;
+  EXPECT_EQ(ParseInteger("42", value), LiteralStatus::kOk);
+  EXPECT_EQ(value, 42);
+  EXPECT_EQ(ParseInteger("9223372036854775807", value), LiteralStatus::kOk);
+  EXPECT_EQ(value, INT64_MAX);
+}
+
+TEST(NumericLiteralTest, ParseIntegerOutOfRange) {
+  int64_t value = 0;
+  EXPECT_EQ(ParseInteger("9223372036854775808", value), LiteralStatus::kOutOfRange);
+}
+
+TEST(NumericLiteralTest, ParseIntegerMalformed) {
+  int64_t value = 0;
+  EXPECT_EQ(ParseInteger("", value), LiteralStatus::kMalformed);
+  EXPECT_EQ(ParseInteger("12a", value), LiteralStatus::kMalformed);
+  EXPECT_EQ(ParseInteger("1.5", value), LiteralStatus::kMalformed);
+}
+
+TEST(NumericLiteralTest, ParseIntegerDoesNotReadBehindText) {
+  string source = "123456";
+  int64_t value = 0;
+  EXPECT_EQ(ParseInteger(string_view(source).substr(0, 3), value), LiteralStatus::kOk);
+  EXPECT_EQ(value, 123);
+}
+
+TEST(NumericLiteralTest, ParseReal) {
+  double value = 0.0;
+  EXPECT_EQ(ParseReal("3.14159", value), LiteralStatus::kOk);
+  EXPECT_DOUBLE_EQ(value, 3.14159);
+  EXPECT_EQ(ParseReal("20", value), LiteralStatus::kOk);
+  EXPECT_DOUBLE_EQ(value, 20.0);
+}
+
+TEST(NumericLiteralTest, ParseRealErrors) {
+  double value = 0.0;
+  EXPECT_EQ(ParseReal("1e999", value), LiteralStatus::kOutOfRange);
+  EXPECT_EQ(ParseReal("3.", value), LiteralStatus::kOk);
+  EXPECT_EQ(ParseReal("3.1.4", value), LiteralStatus::kMalformed);
+}
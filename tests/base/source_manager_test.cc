@@ -0,0 +1,72 @@
+#include "base/source_manager.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+using namespace base;
+using namespace std;
+
+class SourceManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override { filename_ = ::testing::TempDir() + "source_manager_test.pas"; }
+  void TearDown() override { std::remove(filename_.c_str()); }
+
+  void WriteFile(const string& content) {
+    ofstream file(filename_, ios::binary);
+    file << content;
+  }
+
+  string filename_;
+};
+
+TEST_F(SourceManagerTest, LoadFile) {
+  WriteFile(string("BEGIN a := 1\0 END.", 18));
+  SourceManager source_manager;
+  auto source = source_manager.Load(filename_);
+
+  ASSERT_NE(source, nullptr);
+  EXPECT_EQ(string(source->begin(), source->end()), string("BEGIN a := 1\0 END.", 18));
+  EXPECT_EQ(source->size(), 18u);
+  EXPECT_EQ(source->GetName(), filename_);
+  EXPECT_EQ(source_manager.NumBuffers(), 1u);
+}
+
+TEST_F(SourceManagerTest, LoadEmptyFile) {
+  WriteFile("");
+  SourceManager source_manager;
+  auto source = source_manager.Load(filename_);
+
+  ASSERT_NE(source, nullptr);
+  EXPECT_EQ(source->size(), 0u);
+  EXPECT_EQ(source->begin(), source->end());
+}
+
+TEST_F(SourceManagerTest, LoadMissingFile) {
+  SourceManager source_manager;
+  auto source = source_manager.Load(filename_ + ".missing");
+
+  EXPECT_EQ(source, nullptr);
+  EXPECT_EQ(source_manager.NumBuffers(), 0u);
+}
+
+TEST_F(SourceManagerTest, BufferOutlivesManager) {
+  WriteFile("x := 2");
+  SourceManager::buffer_type source;
+  {
+    SourceManager source_manager;
+    source = source_manager.Load(filename_);
+  }
+  ASSERT_NE(source, nullptr);
+  EXPECT_EQ(string(source->begin(), source->end()), "x := 2");
+}
+
+TEST_F(SourceManagerTest, AddString) {
+  SourceManager source_manager;
+  auto source = source_manager.AddString("<memory>", "1+2");
+
+  EXPECT_EQ(string(source->begin(), source->end()), "1+2");
+  EXPECT_FALSE(source->IsMapped());
+}
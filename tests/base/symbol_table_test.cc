@@ -0,0 +1,51 @@
+#include "base/symbol_table.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+using namespace base;
+using namespace std;
+
+TEST(SymbolTableTest, DenseIdsInInternOrder) {
+  SymbolTable symbols;
+  EXPECT_EQ(symbols.Intern("number"), 0u);
+  EXPECT_EQ(symbols.Intern("a"), 1u);
+  EXPECT_EQ(symbols.Intern("number"), 0u);
+  EXPECT_EQ(symbols.size(), 2u);
+}
+
+TEST(SymbolTableTest, CaseInsensitive) {
+  SymbolTable symbols;
+  auto id = symbols.Intern("Number");
+  EXPECT_EQ(symbols.Intern("NUMBER"), id);
+  EXPECT_EQ(symbols.Find("nUmBeR"), id);
+  EXPECT_EQ(symbols.GetName(id), "number");
+}
+
+TEST(SymbolTableTest, FindUnknown) {
+  SymbolTable symbols;
+  symbols.Intern("a");
+  EXPECT_EQ(symbols.Find("b"), SymbolTable::kNoSymbol);
+  EXPECT_EQ(symbols.Find(""), SymbolTable::kNoSymbol);
+  EXPECT_EQ(symbols.size(), 1u);
+}
+
+TEST(SymbolTableTest, InternsFromViews) {
+  string source = "alpha beta ALPHA";
+  SymbolTable symbols;
+  auto alpha = symbols.Intern(string_view(source).substr(0, 5));
+  auto beta = symbols.Intern(string_view(source).substr(6, 4));
+  EXPECT_NE(alpha, beta);
+  EXPECT_EQ(symbols.Intern(string_view(source).substr(11, 5)), alpha);
+}
+
+TEST(SymbolTableTest, Grows) {
+  SymbolTable symbols;
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(symbols.Intern("var" + to_string(i)), static_cast<SymbolTable::symbol_type>(i));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(symbols.Find("VAR" + to_string(i)), static_cast<SymbolTable::symbol_type>(i));
+  }
+}
@@ -0,0 +1,60 @@
+#include "base/token_buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "languages/calc/calc_lexer.h"
+
+using namespace base;
+using namespace languages::calc;
+using namespace std;
+
+TEST(TokenBufferTest, EmptyRange) {
+  const char* line = "   ";
+  CalcLexer lexer(line, strlen(line));
+  TokenBuffer<CalcToken> buffer(lexer.begin(), lexer.end());
+
+  EXPECT_EQ(buffer.size(), 0u);
+  EXPECT_EQ(buffer.begin(), buffer.end());
+}
+
+TEST(TokenBufferTest, StoresTokensOfLexer) {
+  const char* line = "(12 + 3)";
+  CalcLexer lexer(line, strlen(line));
+  TokenBuffer<CalcToken> buffer(lexer.begin(), lexer.end());
+
+  ASSERT_EQ(buffer.size(), 5u);
+  EXPECT_EQ(buffer[0], CalcToken(CalcTokenId::kLParens, "(", 1));
+  EXPECT_EQ(buffer[1], CalcToken(CalcTokenId::kInteger, "12", 2));
+  EXPECT_EQ(buffer[2], CalcToken(CalcTokenId::kPlus, "+", 1));
+  EXPECT_EQ(buffer[3], CalcToken(CalcTokenId::kInteger, "3", 1));
+  EXPECT_EQ(buffer[4], CalcToken(CalcTokenId::kRParens, ")", 1));
+}
+
+TEST(TokenBufferTest, IteratorIsRandomAccess) {
+  const char* line = "1+2";
+  CalcLexer lexer(line, strlen(line));
+  TokenBuffer<CalcToken> buffer(lexer.begin(), lexer.end());
+
+  auto it = buffer.begin();
+  auto backup_it = it;
+  it += 2;
+  EXPECT_EQ(*it, CalcToken(CalcTokenId::kInteger, "2", 1));
+  EXPECT_EQ(buffer.end() - it, 1);
+  it = backup_it;  // backtracking
+  EXPECT_EQ(*it, CalcToken(CalcTokenId::kInteger, "1", 1));
+}
+
+TEST(TokenBufferTest, AssignReplacesTokens) {
+  const char* line1 = "1+2";
+  const char* line2 = "7";
+  CalcLexer lexer1(line1, strlen(line1));
+  CalcLexer lexer2(line2, strlen(line2));
+  TokenBuffer<CalcToken> buffer(lexer1.begin(), lexer1.end());
+  buffer.Assign(lexer2.begin(), lexer2.end());
+
+  ASSERT_EQ(buffer.size(), 1u);
+  EXPECT_EQ(buffer[0], CalcToken(CalcTokenId::kInteger, "7", 1));
+}
@@ -0,0 +1,115 @@
+#include "base/token_store.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "languages/ast_factory.h"
+#include "languages/pascal/pascal_interpreter.h"
+#include "languages/pascal/pascal_lexer.h"
+#include "languages/pascal/pascal_parser.h"
+
+using namespace base;
+using namespace languages::pascal;
+using namespace std;
+
+using PascalTokenStore = TokenStore<PascalTokenId, PascalTokenIdConverter>;
+
+static_assert(std::is_trivially_copyable<PascalToken>::value, "tokens must be trivially copyable");
+static_assert(std::is_trivially_copyable<PascalTokenStore::Handle>::value, "handles must be trivially copyable");
+
+TEST(TokenStoreTest, StoresTokensOfLexer) {
+  const char* line = "a := b1 + 12;";
+  PascalLexer lexer(line, strlen(line));
+  PascalTokenStore store(line, strlen(line));
+  ASSERT_TRUE(store.Assign(lexer.begin(), lexer.end()));
+
+  ASSERT_EQ(store.size(), 6u);
+  EXPECT_EQ(store[0].GetId(), PascalTokenId::kId);
+  EXPECT_EQ(store[0].GetValue(), "a");
+  EXPECT_EQ(store[1].GetId(), PascalTokenId::kAssign);
+  EXPECT_EQ(store[1].GetValue(), ":=");
+  EXPECT_EQ(store[2].GetValue(), "b1");
+  EXPECT_EQ(store[2].GetOffset(), 5u);
+  EXPECT_EQ(store[4].GetId(), PascalTokenId::kIntegerConst);
+  EXPECT_EQ(store[4].GetValue(), "12");
+  EXPECT_EQ(store[5].GetId(), PascalTokenId::kSemi);
+}
+
+TEST(TokenStoreTest, HandleConvertsToToken) {
+  const char* line = "BEGIN END";
+  PascalLexer lexer(line, strlen(line));
+  PascalTokenStore store(line, strlen(line));
+  ASSERT_TRUE(store.Assign(lexer.begin(), lexer.end()));
+
+  EXPECT_EQ(store[1].ToToken(), PascalToken(PascalTokenId::kEnd, &line[6], 3));
+  EXPECT_STREQ(store[1].GetStringId(), "END");
+}
+
+TEST(TokenStoreTest, IteratorIsRandomAccess) {
+  const char* line = "x + y";
+  PascalLexer lexer(line, strlen(line));
+  PascalTokenStore store(line, strlen(line));
+  ASSERT_TRUE(store.Assign(lexer.begin(), lexer.end()));
+
+  auto it = store.begin();
+  EXPECT_EQ(store.end() - it, 3);
+  it += 2;
+  EXPECT_EQ((*it).GetValue(), "y");
+  --it;
+  EXPECT_EQ((*it).GetId(), PascalTokenId::kPlus);
+  ++it;
+  ++it;
+  EXPECT_EQ(it, store.end());
+
+  it = 1 + store.begin();
+  EXPECT_EQ(*it, PascalToken(PascalTokenId::kPlus, &line[2], 1));
+  EXPECT_TRUE(it > store.begin());
+  EXPECT_TRUE(it >= store.begin());
+  EXPECT_TRUE(it <= it);
+  EXPECT_FALSE(it <= store.begin());
+}
+
+TEST(TokenStoreTest, TokensWhichCantBeStored) {
+  const char* line = "ab 1";
+  const char* other = "cd";
+  PascalTokenStore store(line, strlen(line));
+
+  EXPECT_FALSE(store.Add(PascalTokenId::kId, &other[0], &other[2]));
+  EXPECT_FALSE(store.Add(PascalTokenId::kId, &line[2], &line[1]));
+  EXPECT_FALSE(store.Add(static_cast<PascalTokenId>(256), &line[0], &line[2]));
+  EXPECT_EQ(store.size(), 0u);
+
+  PascalToken tokens[] = {PascalToken(PascalTokenId::kId, &line[0], 2), PascalToken(PascalTokenId::kId, &other[0], 2)};
+  EXPECT_FALSE(store.Assign(std::begin(tokens), std::end(tokens)));
+  EXPECT_EQ(store.size(), 1u);
+}
+
+TEST(TokenStoreTest, GrammarParsesTokensOfTheStore) {
+  const char* program = "PROGRAM p; VAR a, b : INTEGER; BEGIN a := 2; b := a * 10 + 5 END.";
+  PascalLexer lexer(program, strlen(program));
+  PascalTokenStore store(program, strlen(program));
+  ASSERT_TRUE(store.Assign(lexer.begin(), lexer.end()));
+
+  languages::AstFactory<std::shared_ptr<languages::Ast<languages::MakeShared, PascalToken>>, PascalToken> ast_factory;
+  PascalStaticParserFactory parser_factory(ast_factory);
+  PascalStoreParser parser(parser_factory);
+  auto result = parser.Expr(store.begin(), store.end());
+  ASSERT_FALSE(result.is_error);
+
+  PascalInterpreter<languages::MakeShared, PascalToken> interpreter;
+  EXPECT_EQ(interpreter.Interpret(result.node, ast_factory.GetSymbolTable()).ListVariables(), "a := 2\nb := 25\n");
+}
+
+TEST(TokenStoreTest, ParallelArrays) {
+  const char* line = "ab 1";
+  PascalTokenStore store(line, strlen(line));
+  store.Add(PascalTokenId::kId, &line[0], &line[2]);
+  store.Add(PascalTokenId::kIntegerConst, &line[3], &line[4]);
+
+  EXPECT_EQ(store.ids()[1], static_cast<uint8_t>(PascalTokenId::kIntegerConst));
+  EXPECT_EQ(store.offsets()[1], 3u);
+  EXPECT_EQ(store.lengths()[0], 2u);
+}
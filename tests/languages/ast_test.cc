@@ -5,6 +5,8 @@
 
 #include <memory>
 
+#include "languages/ast_factory.h"
+
 using namespace languages;
 using namespace std;
 
@@ -44,6 +46,20 @@ TEST(AstTest, Num) {
   num1.Accept(mock_visitor);
 }
 
+TEST(AstTest, ConstIsDecoded) {
+  auto num = AstConst<MockMakePtr, MockToken>(ConstType::kInteger, "42");
+  EXPECT_EQ(num.GetStatus(), base::LiteralStatus::kOk);
+  EXPECT_EQ(num.GetInteger(), 42);
+  EXPECT_DOUBLE_EQ(num.GetReal(), 42.0);
+
+  auto real = AstConst<MockMakePtr, MockToken>(ConstType::kReal, "3.5");
+  EXPECT_DOUBLE_EQ(real.GetReal(), 3.5);
+
+  auto malformed = AstConst<MockMakePtr, MockToken>(ConstType::kInteger, "4x");
+  EXPECT_EQ(malformed.GetStatus(), base::LiteralStatus::kMalformed);
+  EXPECT_EQ(malformed.GetInteger(), 0);
+}
+
 TEST(AstTest, BinOp) {
   MockAstVisitor mock_visitor;
   auto num1 = AstConst<MockMakePtr, MockToken>(ConstType::kInteger, "2");
@@ -54,3 +70,14 @@ TEST(AstTest, BinOp) {
 
   op.Accept(mock_visitor);
 }
+
+TEST(AstTest, FactoryInternsIdentifiers) {
+  AstFactory<std::shared_ptr<Ast<MakeShared, MockToken>>, MockToken> factory;
+  auto first = std::dynamic_pointer_cast<AstId<MakeShared, MockToken>>(factory.CreateId("Number"));
+  auto second = std::dynamic_pointer_cast<AstId<MakeShared, MockToken>>(factory.CreateId("NUMBER"));
+  auto decl = std::dynamic_pointer_cast<AstVariableDeclaration<MakeShared, MockToken>>(factory.CreateVariableDeclaration("number", "INTEGER"));
+
+  EXPECT_EQ(first->GetSymbol(), second->GetSymbol());
+  EXPECT_EQ(decl->GetSymbol(), first->GetSymbol());
+  EXPECT_EQ(factory.GetSymbolTable()->GetName(first->GetSymbol()), "number");
+}
@@ -133,3 +133,40 @@ TEST(CalcIntegrationTest, Equation_lp_1_p_2_rp_mul_lp_2_p_1_rp) {
   auto res = CalcInterpreter.Interpret(parser_res.node);
   EXPECT_EQ("9", res);
 }
+
+TEST(CalcIntegrationTest, PackratParserGivesSameResults) {
+  const char* lines[] = {"1", "-1+2", "5+5*6+(4+2)+(50 * 60)-1", "((((((((2))))))))*-(3-+4)", "2*(3+4)*(5-(6/2))", "1+", "(1"};
+  for (const char* line : lines) {
+    CalcLexer lexer(line, strlen(line));
+    AstFactory<std::shared_ptr<Ast<MakeShared, CalcToken>>, CalcToken> ast_factory;
+    CalcParserFactory parser_factory(ast_factory);
+    CalcParser parser(parser_factory);
+    CalcPackratParser packrat_parser(parser_factory);
+
+    auto parser_res = parser.Expr(lexer.begin(), lexer.end());
+    auto packrat_res = packrat_parser.Expr(lexer.begin(), lexer.end());
+    EXPECT_EQ(parser_res.is_error, packrat_res.is_error) << line;
+    if (!parser_res.is_error) {
+      CalcInterpreter<MakeShared, CalcToken> calc_interpreter;
+      EXPECT_EQ(calc_interpreter.Interpret(parser_res.node), calc_interpreter.Interpret(packrat_res.node)) << line;
+    }
+  }
+}
+
+TEST(CalcIntegrationTest, StaticParserGivesSameResults) {
+  const char* lines[] = {"1", "-1+2", "5+5*6+(4+2)+(50 * 60)-1", "((((((((2))))))))*-(3-+4)", "2*(3+4)*(5-(6/2))"};
+  for (const char* line : lines) {
+    CalcLexer lexer(line, strlen(line));
+    AstFactory<std::shared_ptr<Ast<MakeShared, CalcToken>>, CalcToken> ast_factory;
+    CalcParserFactory parser_factory(ast_factory);
+    CalcStaticParserFactory static_parser_factory(ast_factory);
+    CalcParser parser(parser_factory);
+    CalcStaticParser static_parser(static_parser_factory);
+
+    auto parser_res = parser.Expr(lexer.begin(), lexer.end());
+    auto static_res = static_parser.Expr(lexer.begin(), lexer.end());
+    ASSERT_FALSE(static_res.is_error) << line;
+    CalcInterpreter<MakeShared, CalcToken> calc_interpreter;
+    EXPECT_EQ(calc_interpreter.Interpret(parser_res.node), calc_interpreter.Interpret(static_res.node)) << line;
+  }
+}
@@ -65,6 +65,15 @@ TEST(CalcInterpreterTest, Visit_Num) {
   EXPECT_EQ("3", res);
 }
 
+TEST(CalcInterpreterTest, Visit_Num_OutOfRange) {
+  MockAstConst ast_const(ConstType::kInteger, MockToken("99999999999"));
+  EXPECT_CALL(ast_const, Accept(_)).WillOnce([&](IAstVisitor<MockMakePtr, MockToken>& value) { return value.Visit(ast_const); });
+
+  CalcInterpreter<MockMakePtr, MockToken> CalcInterpreter;
+  auto res = CalcInterpreter.Interpret(&ast_const);
+  EXPECT_EQ("ERROR: Literal out of range", res);
+}
+
 TEST(CalcInterpreterTest, Visit_Unary_Num) {
   MockAstConst ast_const(ConstType::kInteger, MockToken("3"));
   EXPECT_CALL(ast_const, Accept(_)).WillOnce([&](IAstVisitor<MockMakePtr, MockToken>& value) { return value.Visit(ast_const); });
@@ -349,6 +349,7 @@ TEST(CalcParserTest, WrongFormat) {
   auto result = parser.Expr(input.begin(), input.end());
   EXPECT_EQ(result.node, "NULL");
   EXPECT_EQ(result.error_msg, "ERROR: Tokens left");
+  EXPECT_EQ(result.error_position, input[1].GetValue().data());
 }
 
 TEST(CalcParserTest, WrongFormat2) {
@@ -0,0 +1,54 @@
+#include "languages/pascal/pascal_interpreter.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "languages/ast_factory.h"
+#include "languages/ast_types.h"
+#include "languages/pascal/pascal_token.h"
+
+using namespace languages;
+using namespace languages::pascal;
+using namespace std;
+
+namespace {
+using Node = shared_ptr<Ast<MakeShared, PascalToken>>;
+
+PascalToken Token(PascalTokenId id, const char* text) { return PascalToken(id, text, char_traits<char>::length(text)); }
+
+// Built without AstFactory, so the ids have no symbol.
+Node Id(const char* name) { return make_shared<AstId<MakeShared, PascalToken>>(Token(PascalTokenId::kId, name), base::SymbolTable::kNoSymbol); }
+
+Node Const(const char* value) { return make_shared<AstConst<MakeShared, PascalToken>>(ConstType::kInteger, Token(PascalTokenId::kIntegerConst, value)); }
+
+Node Assign(Node lhs, Node rhs) { return make_shared<AstBinaryOp<MakeShared, PascalToken>>(lhs, Token(PascalTokenId::kAssign, ":="), rhs); }
+
+Node Multiply(Node lhs, Node rhs) { return make_shared<AstBinaryOp<MakeShared, PascalToken>>(lhs, Token(PascalTokenId::kMultiply, "*"), rhs); }
+}  // namespace
+
+TEST(PascalInterpreterTest, NodesWithoutSymbolAreLookedUpByName) {
+  // a := 2; B := A * 3
+  auto program = make_shared<AstCompoundStatement<MakeShared, PascalToken>>(
+      vector<Node>{Assign(Id("a"), Const("2")), Assign(Id("B"), Multiply(Id("A"), Const("3")))});
+
+  PascalInterpreter<MakeShared, PascalToken> interpreter;
+  EXPECT_EQ(interpreter.Interpret(program).ListVariables(), "a := 2\nb := 6\n");
+  EXPECT_EQ(interpreter.Interpret(program, make_shared<const base::SymbolTable>()).ListVariables(), "a := 2\nb := 6\n");
+}
+
+TEST(PascalInterpreterTest, NodesWithAndWithoutSymbolShareTheVariables) {
+  AstFactory<Node, PascalToken> ast_factory;
+  auto interned = ast_factory.CreateId(Token(PascalTokenId::kId, "x"));
+
+  // x := 4; y := X * 5 where only the first x is interned
+  auto program = make_shared<AstCompoundStatement<MakeShared, PascalToken>>(
+      vector<Node>{Assign(interned, Const("4")), Assign(Id("y"), Multiply(Id("X"), Const("5")))});
+
+  PascalInterpreter<MakeShared, PascalToken> interpreter;
+  EXPECT_EQ(interpreter.Interpret(program, ast_factory.GetSymbolTable()).ListVariables(), "x := 4\ny := 20\n");
+
+  // the old signature ignores the symbols
+  EXPECT_EQ(interpreter.Interpret(program).ListVariables(), "x := 4\ny := 20\n");
+}
@@ -0,0 +1,72 @@
+#include "lexer/lexer_char_class.h"
+
+#include <gtest/gtest.h>
+
+#include "lexer/lexer_predicates.h"
+#include "lexer/lexer_transforms.h"
+
+using namespace lexer;
+
+namespace {
+
+bool IsDigitReference(char ch) { return ('0' <= ch) && (ch <= '9'); }
+bool IsLowerCaseLetterReference(char ch) { return ('a' <= ch) && (ch <= 'z'); }
+bool IsUpperCaseLetterReference(char ch) { return ('A' <= ch) && (ch <= 'Z'); }
+
+struct IsHexDigitSlow {
+  constexpr bool operator()(char ch) const { return (('0' <= ch) && (ch <= '9')) || (('a' <= ch) && (ch <= 'f')) || (('A' <= ch) && (ch <= 'F')); }
+};
+
+using IsHexDigit = PredicateTable<IsHexDigitSlow>;
+
+// can't be evaluated at compile time
+struct IsDollarAtRuntime {
+  bool operator()(char ch) const { return ch == '$'; }
+};
+
+}  // namespace
+
+TEST(CharClassTest, BuiltinClassesMatchReference) {
+  for (unsigned i = 0; i < 256; ++i) {
+    char ch = static_cast<char>(i);
+    EXPECT_EQ(IsDigit()(ch), IsDigitReference(ch)) << i;
+    EXPECT_EQ(IsLowerCaseLetter()(ch), IsLowerCaseLetterReference(ch)) << i;
+    EXPECT_EQ(IsUpperCaseLetter()(ch), IsUpperCaseLetterReference(ch)) << i;
+    EXPECT_EQ(IsLetter()(ch), IsLowerCaseLetterReference(ch) || IsUpperCaseLetterReference(ch)) << i;
+    EXPECT_EQ(IsLetterOrDigit()(ch), IsLowerCaseLetterReference(ch) || IsUpperCaseLetterReference(ch) || IsDigitReference(ch)) << i;
+  }
+}
+
+TEST(CharClassTest, PredicateOr) {
+  PredicateOr<IsLetter, IsChar<'_'>> pred;
+  EXPECT_TRUE(pred('_'));
+  EXPECT_TRUE(pred('q'));
+  EXPECT_FALSE(pred('1'));
+  static_assert(PredicateOr<IsDigit, IsChar<'.'>>()('.'), "");
+}
+
+TEST(CharClassTest, PredicateOrWithRuntimePredicate) {
+  static_assert(!is_constexpr_predicate<PredicateOr<IsLetter, IsDollarAtRuntime>::Evaluate>::value);
+  PredicateOr<IsLetter, IsDollarAtRuntime> pred;
+  EXPECT_TRUE(pred('$'));
+  EXPECT_TRUE(pred('q'));
+  EXPECT_FALSE(pred('1'));
+}
+
+TEST(CharClassTest, CustomClass) {
+  for (unsigned i = 0; i < 256; ++i) {
+    char ch = static_cast<char>(i);
+    EXPECT_EQ(IsHexDigit()(ch), IsHexDigitSlow()(ch)) << i;
+  }
+  static_assert(IsHexDigit()('F'), "");
+}
+
+TEST(CharClassTest, ToLowerCase) {
+  ToLowerCase to_lower_case;
+  EXPECT_EQ(to_lower_case('A'), 'a');
+  EXPECT_EQ(to_lower_case('Z'), 'z');
+  EXPECT_EQ(to_lower_case('a'), 'a');
+  EXPECT_EQ(to_lower_case('['), '[');
+  EXPECT_EQ(to_lower_case('@'), '@');
+  EXPECT_EQ(to_lower_case('\xC4'), '\xC4');
+}
@@ -0,0 +1,64 @@
+#include "lexer/lexer_constexpr.h"
+
+#include <gtest/gtest.h>
+
+#include <string_view>
+#include <vector>
+
+#include "languages/calc/calc_lexer.h"
+#include "languages/pascal/pascal_lexer.h"
+
+using namespace lexer;
+using namespace std;
+
+namespace {
+
+using CalcRules = languages::calc::CalcLexerRules::type;
+using PascalRules = languages::pascal::PascalLexerRules::type;
+using languages::calc::CalcTokenId;
+using languages::pascal::PascalTokenId;
+
+constexpr string_view kCalcSource = "5 + 5*6 - (40 / 2)";
+constexpr auto kCalcTokens = LexToArray<CalcRules, CountTokens<CalcRules>(kCalcSource)>(kCalcSource);
+
+constexpr string_view kPascalSource = "BEGIN { comment }\n  Number := 3.14 * x1;\nEND.";
+constexpr auto kPascalTokens = LexToArray<PascalRules, CountTokens<PascalRules>(kPascalSource)>(kPascalSource);
+
+// everything below is evaluated by the compiler
+static_assert(CountTokens<CalcRules>("") == 0);
+static_assert(CountTokens<CalcRules>("   ") == 0);
+static_assert(kCalcTokens.size() == 11);
+static_assert(kCalcTokens[0].GetId() == CalcTokenId::kInteger);
+static_assert(kCalcTokens[0].GetValue() == "5");
+static_assert(kCalcTokens[3].GetValue() == "*");
+static_assert(kCalcTokens[10].GetId() == CalcTokenId::kRParens);
+
+static_assert(kPascalTokens.size() == 9);
+static_assert(kPascalTokens[0].GetId() == PascalTokenId::kBegin);
+static_assert(kPascalTokens[1].GetId() == PascalTokenId::kId);
+static_assert(kPascalTokens[1].GetValue() == "Number");
+static_assert(kPascalTokens[2].GetId() == PascalTokenId::kAssign);
+static_assert(kPascalTokens[3].GetId() == PascalTokenId::kRealConst);
+static_assert(kPascalTokens[8].GetId() == PascalTokenId::kDot);
+
+template <typename TLexer, typename TArray>
+void ExpectSameAsLexer(string_view source, const TArray& tokens) {
+  vector<typename TLexer::value_type> expected;
+  TLexer lexer(source.data(), source.size());
+  for (auto it = lexer.begin(); it != lexer.end(); ++it) {
+    expected.push_back(*it);
+  }
+  EXPECT_EQ(expected, vector<typename TLexer::value_type>(tokens.begin(), tokens.end()));
+}
+
+}  // namespace
+
+TEST(LexerConstexprTest, CalcTokensAreTheSameAsAtRuntime) { ExpectSameAsLexer<languages::calc::CalcLexer>(kCalcSource, kCalcTokens); }
+
+TEST(LexerConstexprTest, PascalTokensAreTheSameAsAtRuntime) { ExpectSameAsLexer<languages::pascal::PascalLexer>(kPascalSource, kPascalTokens); }
+
+TEST(LexerConstexprTest, ShortArrayHoldsTheFirstTokens) {
+  constexpr auto tokens = LexToArray<CalcRules, 2>(kCalcSource);
+  EXPECT_EQ(tokens[0].GetValue(), "5");
+  EXPECT_EQ(tokens[1].GetValue(), "+");
+}
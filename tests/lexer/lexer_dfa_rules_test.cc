@@ -0,0 +1,233 @@
+#include "lexer/lexer_dfa_rules.h"
+
+#include <gtest/gtest.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "languages/calc/calc_lexer.h"
+#include "languages/pascal/pascal_lexer.h"
+#include "lexer/lexer.h"
+#include "lexer/lexer_predicates.h"
+#include "token_out.h"
+
+using namespace lexer;
+using namespace std;
+
+template <typename TLexer>
+vector<typename TLexer::value_type> Tokenize(const string& input) {
+  vector<typename TLexer::value_type> tokens;
+  TLexer lexer(input.data(), input.size());
+  for (auto it = lexer.begin(); it != lexer.end(); ++it) {
+    tokens.push_back(*it);
+  }
+  return tokens;
+}
+
+template <typename TLexer>
+string ToString(const vector<typename TLexer::value_type>& tokens) {
+  stringstream ss;
+  for (auto& token : tokens) {
+    ss << token << " ";
+  }
+  return ss.str();
+}
+
+//----------------------------------------------------------------------------
+// DfaLexerRules Tests
+//----------------------------------------------------------------------------
+class DfaLexerRulesTest : public ::testing::Test {
+ protected:
+  void SetUp() override {}
+};
+
+using MockToken = string;
+
+template <unsigned Tid>
+class MockDfaProduction {
+ public:
+  using value_type = MockToken;
+
+  value_type Create(const char* begin, const char* end) { return to_string(Tid) + ":" + string(begin, end); }
+};
+
+struct MockStringProviderAb {
+  static constexpr const char* GetString() { return "ab"; }
+};
+
+TEST_F(DfaLexerRulesTest, NoMatchConsumesOneChar) {
+  DfaLexerRules<MockDfaProduction<0>, MockDfaProduction<1>, Rule<MockDfaProduction<2>, MatcherPredicate<IsChar<'a'>>>> rules;
+  const char* test_str = "ba";
+  auto match_result = rules.Match(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(match_result, "0:b");
+  EXPECT_EQ(rules.GetPosition(), &test_str[1]);
+}
+
+TEST_F(DfaLexerRulesTest, CoalescedNoMatchConsumesAllUnknownChars) {
+  DfaLexerRules<CoalesceUnknown<MockDfaProduction<0>>, MockDfaProduction<1>, Rule<MockDfaProduction<2>, MatcherPredicate<IsChar<'a'>>>> rules;
+  const char* test_str = "bcda";
+  auto match_result = rules.Match(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(match_result, "0:bcd");
+  EXPECT_EQ(rules.GetPosition(), &test_str[3]);
+}
+
+TEST_F(DfaLexerRulesTest, EndOfFile) {
+  DfaLexerRules<MockDfaProduction<0>, MockDfaProduction<1>, Rule<MockDfaProduction<2>, MatcherPredicate<IsChar<'a'>>>> rules;
+  const char* test_str = "";
+  auto match_result = rules.Match(test_str, test_str);
+  EXPECT_EQ(match_result, "1:");
+  EXPECT_EQ(rules.GetPosition(), test_str);
+}
+
+TEST_F(DfaLexerRulesTest, FirstMatchingRuleWinsEvenIfShorter) {
+  DfaLexerRules<                  //
+      MockDfaProduction<0>,       // unknown
+      MockDfaProduction<1>,       // end of file
+      Rule<MockDfaProduction<2>, MatcherString<MockStringProviderAb>>,
+      Rule<MockDfaProduction<3>, MatcherRangeByPredicate<IsLetter>>>
+      rules;
+  const char* test_str = "abc";
+  auto match_result = rules.Match(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(match_result, "2:ab");
+  EXPECT_EQ(rules.GetPosition(), &test_str[2]);
+}
+
+TEST_F(DfaLexerRulesTest, FallsBackToLaterRuleWhenEarlierRuleFails) {
+  DfaLexerRules<                  //
+      MockDfaProduction<0>,       // unknown
+      MockDfaProduction<1>,       // end of file
+      Rule<MockDfaProduction<2>, MatcherSequence<MatcherRangeByPredicate<IsDigit>, MatcherPredicate<IsChar<'.'>>, MatcherRangeByPredicate<IsDigit>>>,
+      Rule<MockDfaProduction<3>, MatcherRangeByPredicate<IsDigit>>>
+      rules;
+  const char* test_str = "123.x";
+  auto match_result = rules.Match(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(match_result, "3:123");
+  EXPECT_EQ(rules.GetPosition(), &test_str[3]);
+}
+
+TEST_F(DfaLexerRulesTest, SkipRulesAreSkipped) {
+  DfaLexerRules<                  //
+      MockDfaProduction<0>,       // unknown
+      MockDfaProduction<1>,       // end of file
+      Rule<SkipProduction, MatcherRangeByPredicate<IsChar<' '>>>,
+      Rule<MockDfaProduction<2>, MatcherRangeByPredicate<IsLetter>>>
+      rules;
+  const char* test_str = "   abc ";
+  auto match_result = rules.Match(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(match_result, "2:abc");
+  EXPECT_EQ(rules.GetPosition(), &test_str[6]);
+}
+
+//----------------------------------------------------------------------------
+// LongestMatchLexerRules Tests
+//----------------------------------------------------------------------------
+TEST_F(DfaLexerRulesTest, LongestMatchWinsOverDeclarationOrder) {
+  LongestMatchLexerRules<         //
+      MockDfaProduction<0>,       // unknown
+      MockDfaProduction<1>,       // end of file
+      Rule<MockDfaProduction<2>, MatcherString<MockStringProviderAb>>,
+      Rule<MockDfaProduction<3>, MatcherRangeByPredicate<IsLetter>>>
+      rules;
+  const char* test_str = "abc";
+  auto match_result = rules.Match(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(match_result, "3:abc");
+  EXPECT_EQ(rules.GetPosition(), &test_str[3]);
+}
+
+TEST_F(DfaLexerRulesTest, LongestMatchTiesGoToFirstDeclaredRule) {
+  LongestMatchLexerRules<         //
+      MockDfaProduction<0>,       // unknown
+      MockDfaProduction<1>,       // end of file
+      Rule<MockDfaProduction<2>, MatcherString<MockStringProviderAb>>,
+      Rule<MockDfaProduction<3>, MatcherRangeByPredicate<IsLetter>>>
+      rules;
+  const char* test_str = "ab ab";
+  auto match_result = rules.Match(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(match_result, "2:ab");
+  EXPECT_EQ(rules.GetPosition(), &test_str[2]);
+
+  match_result = rules.Match(&test_str[3], &test_str[strlen(test_str)]);  // the tie is decided at the end of the input
+  EXPECT_EQ(match_result, "2:ab");
+}
+
+TEST_F(DfaLexerRulesTest, LongestMatchDoesNotDependOnRuleOrder) {
+  using TestRules = LongestMatchLexerRules<  //
+      MockDfaProduction<0>,                 // unknown
+      MockDfaProduction<1>,                 // end of file
+      Rule<SkipProduction, MatcherRangeByPredicate<IsChar<' '>>>,
+      Rule<MockDfaProduction<2>, MatcherPredicate<IsChar<':'>>>,
+      Rule<MockDfaProduction<3>, MatcherSequence<MatcherPredicate<IsChar<':'>>, MatcherPredicate<IsChar<'='>>>>,
+      Rule<MockDfaProduction<4>, MatcherRangeByPredicate<IsDigit>>,
+      Rule<MockDfaProduction<5>, MatcherSequence<MatcherRangeByPredicate<IsDigit>, MatcherPredicate<IsChar<'.'>>, MatcherRangeByPredicate<IsDigit>>>>;
+  using TestLexer = Lexer<TestRules>;
+  EXPECT_EQ(ToString<TestLexer>(Tokenize<TestLexer>(": := 12 12.5 12.")), "2:: 3::= 4:12 5:12.5 4:12 0:. ");
+}
+
+//----------------------------------------------------------------------------
+// Compare with LexerRules
+//----------------------------------------------------------------------------
+class DfaLexerRulesEquivalenceTest : public ::testing::TestWithParam<const char*> {};
+
+TEST_P(DfaLexerRulesEquivalenceTest, PascalTokenStreamsAreEqual) {
+  using namespace languages::pascal;
+  auto expected = Tokenize<PascalLexer>(GetParam());
+  auto actual = Tokenize<PascalDfaLexer>(GetParam());
+  EXPECT_EQ(ToString<PascalLexer>(expected), ToString<PascalDfaLexer>(actual));
+}
+
+TEST_P(DfaLexerRulesEquivalenceTest, CalcTokenStreamsAreEqual) {
+  using namespace languages::calc;
+  auto expected = Tokenize<CalcLexer>(GetParam());
+  auto actual = Tokenize<CalcDfaLexer>(GetParam());
+  EXPECT_EQ(ToString<CalcLexer>(expected), ToString<CalcDfaLexer>(actual));
+}
+
+TEST_P(DfaLexerRulesEquivalenceTest, PascalLongestMatchTokenStreamsAreEqual) {
+  // the pascal rules are ordered such that the first match is the longest one
+  using namespace languages::pascal;
+  using LongestMatchLexer = Lexer<PascalLexerRules::rules<LongestMatchLexerRules>>;
+  auto expected = Tokenize<PascalLexer>(GetParam());
+  auto actual = Tokenize<LongestMatchLexer>(GetParam());
+  EXPECT_EQ(ToString<PascalLexer>(expected), ToString<LongestMatchLexer>(actual));
+}
+
+TEST_P(DfaLexerRulesEquivalenceTest, PascalRecoveringTokenStreamsAreEqual) {
+  using namespace languages::pascal;
+  using RecoveringLexer = Lexer<PascalLexerRules::rules<LexerRules, CoalesceUnknown<PascalLexerProduction<PascalTokenId::kUnknown>>>>;
+  auto expected = Tokenize<RecoveringLexer>(GetParam());
+  auto actual = Tokenize<PascalRecoveringLexer>(GetParam());
+  EXPECT_EQ(ToString<RecoveringLexer>(expected), ToString<PascalRecoveringLexer>(actual));
+}
+
+TEST(DfaLexerRulesRecoveryTest, GarbageBecomesFewTokens) {
+  using namespace languages::pascal;
+  string input = "a := 1;\n";
+  for (int i = 0; i < 1000; ++i) {
+    input += static_cast<char>(0x80 + i % 64);
+  }
+  input += "\nb := 2;";
+  EXPECT_EQ(Tokenize<PascalDfaLexer>(input).size(), 1008u);
+  EXPECT_EQ(Tokenize<PascalRecoveringLexer>(input).size(), 9u);
+
+  using BudgetLexer = Lexer<PascalLexerRules::recovering_type<1>>;
+  string two_errors = "a ? b ? c";
+  EXPECT_EQ(Tokenize<BudgetLexer>(two_errors).size(), 3u);  // a ? b, then the lexer stops
+}
+
+INSTANTIATE_TEST_SUITE_P(Inputs, DfaLexerRulesEquivalenceTest,
+                         ::testing::Values("",                                                                      //
+                                           "   ",                                                                   //
+                                           "PROGRAM Part10;\nVAR\n   number : INTEGER;\n   y : REAL;\n",            //
+                                           "BEGIN\n  a := NumBer;\n  B := 10 * a + 10 * NUMBER div 4;\nEND.",       //
+                                           "y := 20 / 7 + 3.14; { writeln('y = ', y); }\nEND.   {Part10}",          //
+                                           "BEGINNER endx Div2 vAr _ a _a1 a_",                                     //
+                                           ": := :x 12. 12.x 12.5 .5 3",                                            //
+                                           "{ unterminated comment a := 1",                                         //
+                                           "{}{{}} }{",                                                             //
+                                           "5+5*6+(4+2)+(50 * 60)-1",                                               //
+                                           "#$%&!?\t\r\n\x7f\x80\xff",                                              //
+                                           "INTEGE INTEGER PROGRA PROGRAMS REA REALS",                              //
+                                           "BEGIN\n                                        a := 1;\n                    END",  //
+                                           "{ a long comment which is longer than a single vector register { } b"));
@@ -0,0 +1,160 @@
+#include "lexer/lexer_incremental.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "languages/pascal/pascal_lexer.h"
+#include "token_out.h"
+
+using namespace lexer;
+using namespace languages::pascal;
+using namespace std;
+
+namespace {
+
+const char* kPascalProgram =
+    "PROGRAM Part10;\n"
+    "VAR\n"
+    "   number     : INTEGER;\n"
+    "   a, b, c, x : INTEGER;\n"
+    "   y          : REAL;\n"
+    "{ a comment }\n"
+    "BEGIN {Part10}\n"
+    "   BEGIN\n"
+    "      number := 2;\n"
+    "      a := number;\n"
+    "      b := 10 * a + 10 * number DIV 4;\n"
+    "      c := a - - b\n"
+    "   END;\n"
+    "   x := 11;\n"
+    "   y := 20 / 7 + 3.14159;\n"
+    "END.  {Part10}\n";
+
+template <typename TRules = PascalLexerRules::dfa_type>
+vector<string> LexWhole(const string& input) {
+  vector<string> tokens;
+  Lexer<TRules> lexer(input.data(), input.size());
+  for (auto it = lexer.begin(); it != lexer.end(); ++it) {
+    stringstream ss;
+    ss << *it;
+    tokens.push_back(ss.str());
+  }
+  return tokens;
+}
+
+template <typename TRules>
+vector<string> Tokens(const IncrementalLexer<TRules>& lexer) {
+  vector<string> tokens;
+  for (size_t i = 0; i < lexer.size(); ++i) {
+    stringstream ss;
+    ss << lexer[i];
+    tokens.push_back(ss.str());
+  }
+  return tokens;
+}
+
+struct StringProviderAbcd {
+  static constexpr const char* GetString() { return "abcd"; }
+};
+
+// "abcd" is one token and other letters are tokens of their own, so matching "a" looks three
+// bytes ahead.
+using LookAheadRules = DfaLexerRules<PascalLexerProduction<PascalTokenId::kUnknown>,    //
+                                     PascalLexerProduction<PascalTokenId::kEndOfFile>,  //
+                                     Rule<SkipProduction, MatcherRangeByPredicate<IsChar<' '>>>,
+                                     Rule<PascalLexerProduction<PascalTokenId::kBegin>, MatcherString<StringProviderAbcd>>,
+                                     Rule<PascalLexerProduction<PascalTokenId::kId>, MatcherPredicate<IsLetter>>>;
+
+}  // namespace
+
+TEST(IncrementalLexerTest, InitialTokens) {
+  PascalIncrementalLexer lexer(kPascalProgram);
+  EXPECT_EQ(Tokens(lexer), LexWhole(kPascalProgram));
+}
+
+TEST(IncrementalLexerTest, ChangeIsLocal) {
+  string text;
+  for (int i = 0; i < 100; ++i) {
+    text += kPascalProgram;
+  }
+  PascalIncrementalLexer lexer(text);
+  size_t offset = text.find("number := 2", text.size() / 2);
+
+  auto change = lexer.Apply(offset, 6, "count");
+  EXPECT_EQ(Tokens(lexer), LexWhole(lexer.GetText()));
+  EXPECT_LE(change.removed, 4u);
+  EXPECT_EQ(change.removed, change.inserted);
+}
+
+TEST(IncrementalLexerTest, ChangedRangeReplacesOldTokens) {
+  PascalIncrementalLexer lexer(kPascalProgram);
+  auto before = Tokens(lexer);
+  auto change = lexer.Apply(string(kPascalProgram).find("{ a comment }"), 0, "{ ");
+  auto after = Tokens(lexer);
+  ASSERT_EQ(after, LexWhole(lexer.GetText()));
+
+  // the edit opens a comment which now ends at the old comment's end
+  vector<string> expected(before.begin(), before.begin() + change.first);
+  expected.insert(expected.end(), after.begin() + change.first, after.begin() + change.first + change.inserted);
+  expected.insert(expected.end(), before.begin() + change.first + change.removed, before.end());
+  EXPECT_EQ(after, expected);
+}
+
+TEST(IncrementalLexerTest, UnterminatedCommentRelexesToTheEnd) {
+  PascalIncrementalLexer lexer(kPascalProgram);
+  auto change = lexer.Apply(string(kPascalProgram).find("END."), 0, "{");
+  EXPECT_EQ(Tokens(lexer), LexWhole(lexer.GetText()));
+  EXPECT_EQ(change.first + change.inserted, lexer.size());
+}
+
+TEST(IncrementalLexerTest, RandomEditsMatchFullRelex) {
+  mt19937 random(42);
+  const string alphabet = "ab1 .:=;{}\n(*)+-";
+  PascalIncrementalLexer lexer(kPascalProgram);
+  for (int i = 0; i < 2000; ++i) {
+    size_t size = lexer.GetText().size();
+    size_t offset = random() % (size + 1);
+    size_t removed = random() % 4;
+    string inserted;
+    for (size_t n = random() % 4; n > 0; --n) {
+      inserted += alphabet[random() % alphabet.size()];
+    }
+    lexer.Apply(offset, removed, inserted);
+    ASSERT_EQ(Tokens(lexer), LexWhole(lexer.GetText())) << "edit " << i;
+  }
+}
+
+TEST(IncrementalLexerTest, DeleteEverything) {
+  PascalIncrementalLexer lexer(kPascalProgram);
+  auto change = lexer.Apply(0, string(kPascalProgram).size(), "");
+  EXPECT_EQ(lexer.size(), 0u);
+  EXPECT_EQ(change.inserted, 0u);
+  lexer.Apply(0, 0, "x := 1");
+  EXPECT_EQ(Tokens(lexer), LexWhole("x := 1"));
+}
+
+TEST(IncrementalLexerTest, TokensWhichLookedIntoTheEditAreLexedAgain) {
+  IncrementalLexer<LookAheadRules> lexer("x y abcx");
+  EXPECT_EQ(lexer.size(), 6u);
+
+  // "a" looked at the edited byte, although it starts three tokens in front of it
+  auto change = lexer.Apply(7, 1, "d");
+  EXPECT_EQ(Tokens(lexer), LexWhole<LookAheadRules>("x y abcd"));
+  EXPECT_EQ(lexer.size(), 3u);
+  EXPECT_EQ(change.first, 2u);
+  EXPECT_EQ(change.removed, 4u);
+  EXPECT_EQ(change.inserted, 1u);
+}
+
+TEST(IncrementalLexerTest, TokensWhichDidntLookIntoTheEditAreKept) {
+  IncrementalLexer<LookAheadRules> lexer("x y abcd z");
+  auto change = lexer.Apply(9, 1, "w");
+  EXPECT_EQ(Tokens(lexer), LexWhole<LookAheadRules>("x y abcd w"));
+  EXPECT_EQ(change.first, 3u);
+  EXPECT_EQ(change.removed, 1u);
+  EXPECT_EQ(change.inserted, 1u);
+}
@@ -0,0 +1,76 @@
+#include "lexer/lexer_keywords.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "languages/pascal/pascal_lexer.h"
+
+using namespace lexer;
+using namespace std;
+
+enum class MockKeywordId { kNone, kBegin, kEnd, kDiv };
+
+struct MockStringProviderBegin {
+  static constexpr const char* GetString() { return "BEGIN"; }
+};
+
+struct MockStringProviderEnd {
+  static constexpr const char* GetString() { return "END"; }
+};
+
+struct MockStringProviderDiv {
+  static constexpr const char* GetString() { return "DIV"; }
+};
+
+using MockKeywords = KeywordTable<true,                                                //
+                                  Keyword<MockKeywordId::kBegin, MockStringProviderBegin>,  //
+                                  Keyword<MockKeywordId::kEnd, MockStringProviderEnd>,      //
+                                  Keyword<MockKeywordId::kDiv, MockStringProviderDiv>>;
+
+using MockCaseSensitiveKeywords = KeywordTable<false, Keyword<MockKeywordId::kEnd, MockStringProviderEnd>>;
+
+MockKeywordId FindKeyword(const char* test_str) { return MockKeywords::Find(test_str, &test_str[strlen(test_str)], MockKeywordId::kNone); }
+
+TEST(KeywordTableTest, FindsKeyword) {
+  EXPECT_EQ(FindKeyword("BEGIN"), MockKeywordId::kBegin);
+  EXPECT_EQ(FindKeyword("END"), MockKeywordId::kEnd);
+  EXPECT_EQ(FindKeyword("DIV"), MockKeywordId::kDiv);
+}
+
+TEST(KeywordTableTest, FindsKeywordCaseInsensitive) {
+  EXPECT_EQ(FindKeyword("begin"), MockKeywordId::kBegin);
+  EXPECT_EQ(FindKeyword("eNd"), MockKeywordId::kEnd);
+}
+
+TEST(KeywordTableTest, PrefixesAndExtensionsAreNoKeywords) {
+  EXPECT_EQ(FindKeyword(""), MockKeywordId::kNone);
+  EXPECT_EQ(FindKeyword("BEGI"), MockKeywordId::kNone);
+  EXPECT_EQ(FindKeyword("BEGINNER"), MockKeywordId::kNone);
+  EXPECT_EQ(FindKeyword("ENDX"), MockKeywordId::kNone);
+  EXPECT_EQ(FindKeyword("DIW"), MockKeywordId::kNone);
+}
+
+TEST(KeywordTableTest, CaseSensitive) {
+  const char* test_str = "end";
+  EXPECT_EQ(MockCaseSensitiveKeywords::Find(test_str, &test_str[3], MockKeywordId::kNone), MockKeywordId::kNone);
+  test_str = "END";
+  EXPECT_EQ(MockCaseSensitiveKeywords::Find(test_str, &test_str[3], MockKeywordId::kNone), MockKeywordId::kEnd);
+}
+
+TEST(KeywordTableTest, IsConstexpr) {
+  constexpr const char* test_str = "Div";
+  static_assert(MockKeywords::Find(test_str, test_str + 3, MockKeywordId::kNone) == MockKeywordId::kDiv, "");
+}
+
+TEST(KeywordTableTest, PascalIdentifierWithKeywordPrefixIsAnId) {
+  using namespace languages::pascal;
+  string input = "BEGINNER begin";
+  PascalLexer lexer(input.data(), input.size());
+  auto it = lexer.begin();
+  EXPECT_EQ((*it).GetId(), PascalTokenId::kId);
+  EXPECT_EQ((*it).GetValue(), "BEGINNER");
+  ++it;
+  EXPECT_EQ((*it).GetId(), PascalTokenId::kBegin);
+}
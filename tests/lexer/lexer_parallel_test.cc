@@ -0,0 +1,120 @@
+#include "lexer/lexer_parallel.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "languages/calc/calc_lexer.h"
+#include "languages/pascal/pascal_lexer.h"
+#include "token_out.h"
+
+using namespace lexer;
+using namespace languages::pascal;
+using namespace std;
+
+namespace {
+
+const char* kPascalProgram =
+    "PROGRAM Part10;\n"
+    "VAR\n"
+    "   number     : INTEGER;\n"
+    "   a, b, c, x : INTEGER;\n"
+    "   y          : REAL;\n"
+    "{ a comment\n"
+    "  which spans several lines\n"
+    "  and therefore contains chunk boundaries }\n"
+    "BEGIN {Part10}\n"
+    "   BEGIN\n"
+    "      number := 2;\n"
+    "      a := number;\n"
+    "      averyveryveryverylongidentifier := 10 * a + 10 * number DIV 4;\n"
+    "      c := a - - b\n"
+    "   END;\n"
+    "   x := 11;\n"
+    "   y := 20 / 7 + 3.14159;\n"
+    "END.  {Part10}\n";
+
+template <typename TLexer>
+vector<string> LexSequential(const string& input) {
+  vector<string> tokens;
+  TLexer lexer(input.data(), input.size());
+  for (auto it = lexer.begin(); it != lexer.end(); ++it) {
+    stringstream ss;
+    ss << *it;
+    tokens.push_back(ss.str());
+  }
+  return tokens;
+}
+
+template <typename TParallelLexer>
+vector<string> LexParallel(const string& input, unsigned num_threads, size_t min_chunk_size) {
+  vector<string> tokens;
+  TParallelLexer lexer(input.data(), input.size(), num_threads, min_chunk_size);
+  for (const auto& token : lexer.Tokenize()) {
+    stringstream ss;
+    ss << token;
+    tokens.push_back(ss.str());
+  }
+  return tokens;
+}
+
+string Repeat(const string& input, int count) {
+  string result;
+  for (int i = 0; i < count; ++i) {
+    result += input;
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(ParallelLexerTest, SameTokensForEveryThreadCountAndChunkSize) {
+  string input = Repeat(kPascalProgram, 20);
+  auto expected = LexSequential<PascalDfaLexer>(input);
+  for (unsigned num_threads : {1, 2, 3, 4, 7, 16}) {
+    for (size_t min_chunk_size : {1, 13, 64, 1000}) {
+      EXPECT_EQ(LexParallel<PascalParallelLexer>(input, num_threads, min_chunk_size), expected)
+          << "threads " << num_threads << " min chunk size " << min_chunk_size;
+    }
+  }
+}
+
+TEST(ParallelLexerTest, CommentSpanningAllChunks) {
+  string input = "a := 1; {" + Repeat("x := 2;\n", 200) + "} b := 3;\n" + Repeat("c := 4;\n", 200);
+  auto expected = LexSequential<PascalDfaLexer>(input);
+  PascalParallelLexer lexer(input.data(), input.size(), 8, 16);
+  auto tokens = lexer.Tokenize();
+  ASSERT_EQ(tokens.size(), expected.size());
+  EXPECT_EQ(LexParallel<PascalParallelLexer>(input, 8, 16), expected);
+  // the speculative tokens of the chunks inside the comment are dropped, the chunks behind it
+  // meet the exact stream right behind the closing brace
+  EXPECT_LT(lexer.GetRelexedTokens(), tokens.size());
+}
+
+TEST(ParallelLexerTest, UnterminatedComment) {
+  string input = "a := 1;\n{" + Repeat("b := 2;\n", 100);
+  EXPECT_EQ(LexParallel<PascalParallelLexer>(input, 4, 8), LexSequential<PascalDfaLexer>(input));
+}
+
+TEST(ParallelLexerTest, EmptyInput) {
+  string input;
+  PascalParallelLexer lexer(input.data(), input.size(), 4, 1);
+  EXPECT_TRUE(lexer.Tokenize().empty());
+}
+
+TEST(ParallelLexerTest, TokenPointersIntoInput) {
+  string input = Repeat("first second third\n", 50);
+  PascalParallelLexer lexer(input.data(), input.size(), 4, 16);
+  auto tokens = lexer.Tokenize();
+  ASSERT_EQ(tokens.size(), 150u);
+  EXPECT_EQ(tokens[0].GetValue().data(), input.data());
+  EXPECT_EQ(tokens[149].GetValue(), "third");
+}
+
+TEST(ParallelLexerTest, CalcWithLexerRules) {
+  string input = Repeat("12 + (3*4) - 7 / 2\n", 100);
+  using CalcRulesParallelLexer = ParallelLexer<languages::calc::CalcLexerRules::type>;
+  EXPECT_EQ(LexParallel<CalcRulesParallelLexer>(input, 5, 10), LexSequential<languages::calc::CalcLexer>(input));
+}
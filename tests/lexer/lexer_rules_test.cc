@@ -7,6 +7,8 @@
 #include <string>
 #include <string_view>
 
+#include "lexer/lexer_predicates.h"
+
 using namespace lexer;
 using namespace std;
 
@@ -197,6 +199,30 @@ TEST_F(MatcherSequenceTest, twoMatchersWithSecondNoMatch) {
   EXPECT_EQ(&test_str[0], result_ptr);
 }
 
+//----------------------------------------------------------------------------
+// MatcherIdentifier Tests
+//----------------------------------------------------------------------------
+TEST(MatcherIdentifierTest, Match) {
+  MatcherIdentifier<IsLetter, IsLetterOrDigit> matcher;
+  const char* test_str = "a1b2 c";
+  auto* result_ptr = matcher.Parse(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(result_ptr, &test_str[4]);
+}
+
+TEST(MatcherIdentifierTest, MatchSingleChar) {
+  MatcherIdentifier<IsLetter, IsLetterOrDigit> matcher;
+  const char* test_str = "a";
+  auto* result_ptr = matcher.Parse(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(result_ptr, &test_str[1]);
+}
+
+TEST(MatcherIdentifierTest, NoMatch) {
+  MatcherIdentifier<IsLetter, IsLetterOrDigit> matcher;
+  const char* test_str = "1a";
+  auto* result_ptr = matcher.Parse(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(result_ptr, test_str);
+}
+
 //----------------------------------------------------------------------------
 // LexerRules Tests
 //----------------------------------------------------------------------------
@@ -245,6 +271,32 @@ TEST_F(LexerRulesTest, NoMatch) {
   EXPECT_EQ(rules.GetPosition(), &test_str[1]);  // Unknown char gets consumed
 }
 
+TEST_F(LexerRulesTest, CoalescedNoMatch) {
+  LexerRules<                                      //
+      CoalesceUnknown<MockLexerRulesFactory<0>>,   // unknown factory
+      MockLexerRulesFactory<1>,                    // end of file factory
+      MockLexerRulesMatcher<0, '_'>>
+      rules;
+  const char* test_str = "Test1____";
+  auto match_result = rules.Match(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(match_result, "MockFactory0");
+  EXPECT_EQ(rules.GetPosition(), &test_str[5]);  // all unknown chars get consumed at once
+}
+
+TEST_F(LexerRulesTest, ErrorBudgetStopsLexing) {
+  LexerRules<                                      //
+      CoalesceUnknown<MockLexerRulesFactory<0>, 1>,  // unknown factory
+      MockLexerRulesFactory<1>,                    // end of file factory
+      MockLexerRulesMatcher<0, '_'>>
+      rules;
+  const char* test_str = "ab_cd_";
+  const char* end = &test_str[strlen(test_str)];
+  EXPECT_EQ(rules.Match(test_str, end), "MockFactory0");
+  EXPECT_EQ(rules.Match(rules.GetPosition(), end), "Create0");
+  EXPECT_EQ(rules.Match(rules.GetPosition(), end), "MockFactory1");  // budget used up
+  EXPECT_EQ(rules.GetPosition(), end);
+}
+
 TEST_F(LexerRulesTest, EndOfFileButMatch) {
   LexerRules<                    //
       MockLexerRulesFactory<0>,  // unknown factory
@@ -294,3 +346,98 @@ TEST_F(LexerRulesTest, BothRulesMatchFirstIsSkipped) {
   EXPECT_EQ(match_result, "Create1");
   EXPECT_EQ(rules.GetPosition(), &test_str[2]);
 }
+
+template <unsigned Tid, char TFirstChar>
+class MockLexerRulesAlwaysMatcher {
+ public:
+  using production_type = MockLexerRulesFactory<Tid>;
+  using matcher_type = MatcherPredicate<IsChar<TFirstChar>>;
+
+  const char* Match(const char* begin, const char* end) { return begin + 1; }
+
+  MockToken Create(const char* begin, const char* end) { return "Create" + to_string(Tid); }
+};
+
+TEST_F(LexerRulesTest, RulesWhichCannotStartWithCharAreNotTried) {
+  LexerRules<                              //
+      MockLexerRulesFactory<0>,            // unknown factory
+      MockLexerRulesFactory<1>,            // end of file factory
+      MockLexerRulesAlwaysMatcher<0, '_'>,  //
+      MockLexerRulesAlwaysMatcher<1, 'T'>>
+      rules;
+  const char* test_str = "Test1____";
+  auto match_result = rules.Match(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(match_result, "Create1");
+  EXPECT_EQ(rules.GetPosition(), &test_str[1]);
+}
+
+TEST_F(LexerRulesTest, NoRuleCanStartWithChar) {
+  LexerRules<                              //
+      MockLexerRulesFactory<0>,            // unknown factory
+      MockLexerRulesFactory<1>,            // end of file factory
+      MockLexerRulesAlwaysMatcher<0, '_'>,  //
+      MockLexerRulesAlwaysMatcher<1, 'x'>>
+      rules;
+  const char* test_str = "Test1____";
+  auto match_result = rules.Match(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(match_result, "MockFactory0");
+  EXPECT_EQ(rules.GetPosition(), &test_str[1]);
+}
+
+// its predicate can't be evaluated at compile time
+template <unsigned Tid>
+class MockLexerRulesRuntimeMatcher {
+ public:
+  using production_type = MockLexerRulesFactory<Tid>;
+  using matcher_type = MatcherPredicate<MockPredicate<true>>;
+
+  const char* Match(const char* begin, const char* /*end*/) { return begin + 1; }
+
+  MockToken Create(const char* /*begin*/, const char* /*end*/) { return "Create" + to_string(Tid); }
+};
+
+TEST_F(LexerRulesTest, RuntimePredicateCanStartWithEveryChar) {
+  LexerRules<                              //
+      MockLexerRulesFactory<0>,            // unknown factory
+      MockLexerRulesFactory<1>,            // end of file factory
+      MockLexerRulesAlwaysMatcher<0, '_'>,  //
+      MockLexerRulesRuntimeMatcher<1>>
+      rules;
+  const char* test_str = "Test1____";
+  auto match_result = rules.Match(test_str, &test_str[strlen(test_str)]);
+  EXPECT_EQ(match_result, "Create1");
+  EXPECT_EQ(rules.GetPosition(), &test_str[1]);
+}
+
+//----------------------------------------------------------------------------
+// MatcherFirstSet Tests
+//----------------------------------------------------------------------------
+struct MockStringProviderBegin {
+  static constexpr const char* GetString() { return "begin"; }
+};
+
+TEST(MatcherFirstSetTest, CaseInsensitiveStringStartsWithBothCases) {
+  constexpr CharSet set = MatcherFirstSet<MatcherString<MockStringProviderBegin, true>>::Get();
+  EXPECT_TRUE(set.Contains('b'));
+  EXPECT_TRUE(set.Contains('B'));
+  EXPECT_FALSE(set.Contains('e'));
+}
+
+TEST(MatcherFirstSetTest, SequenceStartsWithFirstMatcher) {
+  constexpr CharSet set = MatcherFirstSet<MatcherSequence<MatcherPredicate<IsChar<':'>>, MatcherPredicate<IsChar<'='>>>>::Get();
+  EXPECT_TRUE(set.Contains(':'));
+  EXPECT_FALSE(set.Contains('='));
+}
+
+TEST(MatcherFirstSetTest, UnknownMatcherStartsWithEveryChar) {
+  constexpr CharSet set = MatcherFirstSet<MockMatcher<'A'>>::Get();
+  EXPECT_TRUE(set == CharSet::All());
+}
+
+TEST(MatcherFirstSetTest, RuntimePredicateStartsWithEveryChar) {
+  static_assert(is_constexpr_predicate<IsChar<'a'>>::value);
+  static_assert(!is_constexpr_predicate<MockPredicate<true>>::value);
+
+  constexpr CharSet set = MatcherFirstSet<MatcherPredicate<MockPredicate<false>>>::Get();
+  EXPECT_TRUE(set == CharSet::All());
+}
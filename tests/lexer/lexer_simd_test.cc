@@ -0,0 +1,163 @@
+#include "lexer/lexer_simd.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "lexer/lexer_rules.h"
+
+using namespace lexer;
+using namespace std;
+using simd::ByteRanges;
+
+namespace {
+
+vector<simd::ScanByteFunction> FindByteImplementations() {
+  vector<simd::ScanByteFunction> result = {&simd::ScanByteScalar<true>, &simd::FindByte};
+#if defined(KOLIBRI_LEXER_SSE2)
+  result.push_back(&simd::ScanByteSse2<true>);
+#endif
+#if defined(KOLIBRI_LEXER_AVX2)
+  if (__builtin_cpu_supports("avx2")) {
+    result.push_back(&simd::ScanByteAvx2<true>);
+  }
+#endif
+  return result;
+}
+
+vector<simd::ScanByteFunction> SkipByteImplementations() {
+  vector<simd::ScanByteFunction> result = {&simd::ScanByteScalar<false>, &simd::SkipByte};
+#if defined(KOLIBRI_LEXER_SSE2)
+  result.push_back(&simd::ScanByteSse2<false>);
+#endif
+#if defined(KOLIBRI_LEXER_AVX2)
+  if (__builtin_cpu_supports("avx2")) {
+    result.push_back(&simd::ScanByteAvx2<false>);
+  }
+#endif
+  return result;
+}
+
+}  // namespace
+
+TEST(SimdTest, FindByteAtEveryPosition) {
+  for (auto find_byte : FindByteImplementations()) {
+    for (size_t len = 0; len < 100; ++len) {
+      for (size_t pos = 0; pos <= len; ++pos) {
+        string test_str(len, 'a');
+        if (pos < len) {
+          test_str[pos] = '}';
+        }
+        const char* begin = test_str.data();
+        EXPECT_EQ(find_byte(begin, begin + len, '}'), begin + pos);
+      }
+    }
+  }
+}
+
+TEST(SimdTest, SkipByteAtEveryPosition) {
+  for (auto skip_byte : SkipByteImplementations()) {
+    for (size_t len = 0; len < 100; ++len) {
+      for (size_t pos = 0; pos <= len; ++pos) {
+        string test_str(len, ' ');
+        if (pos < len) {
+          test_str[pos] = '\xff';
+        }
+        const char* begin = test_str.data();
+        EXPECT_EQ(skip_byte(begin, begin + len, ' '), begin + pos);
+      }
+    }
+  }
+}
+
+TEST(SimdTest, MatcherRangeByCharSkipsLongRun) {
+  MatcherRangeByPredicate<IsChar<' '>> matcher;
+  string test_str = string(77, ' ') + "x";
+  auto* result_ptr = matcher.Parse(test_str.data(), test_str.data() + test_str.size());
+  EXPECT_EQ(result_ptr, test_str.data() + 77);
+}
+
+struct MockStringProviderOpen {
+  static constexpr const char* GetString() { return "(*"; }
+};
+
+struct MockStringProviderClose {
+  static constexpr const char* GetString() { return "*)"; }
+};
+
+using MockCommentMatcher = MatcherRangeByStartStopDelimiter<MatcherString<MockStringProviderOpen>, MatcherString<MockStringProviderClose>>;
+
+TEST(SimdTest, MatcherRangeByStartStopFindsStopString) {
+  MockCommentMatcher matcher;
+  string test_str = "(*" + string(40, 'a') + "* ) **" + string(40, 'b') + "*) x";
+  auto* result_ptr = matcher.Parse(test_str.data(), test_str.data() + test_str.size());
+  EXPECT_EQ(result_ptr, test_str.data() + test_str.size() - 2);
+}
+
+TEST(SimdTest, MatcherRangeByStartStopUnterminated) {
+  MockCommentMatcher matcher;
+  string test_str = "(*" + string(40, 'a') + "*";
+  auto* result_ptr = matcher.Parse(test_str.data(), test_str.data() + test_str.size());
+  EXPECT_EQ(result_ptr, test_str.data());
+}
+
+TEST(SimdTest, ByteRangesOfLetterOrDigit) {
+  constexpr ByteRanges ranges = simd::MakeByteRanges<IsLetterOrDigit>();
+  static_assert(ranges.size == 3, "");
+  EXPECT_EQ(ranges.lo[0], '0');
+  EXPECT_EQ(ranges.hi[0], '9');
+  EXPECT_EQ(ranges.lo[1], 'A');
+  EXPECT_EQ(ranges.hi[1], 'Z');
+  EXPECT_EQ(ranges.lo[2], 'a');
+  EXPECT_EQ(ranges.hi[2], 'z');
+}
+
+template <typename TPredicate>
+vector<simd::ScanRangeFunction> ScanRangeImplementations() {
+  vector<simd::ScanRangeFunction> result = {&simd::ScanRangeScalar<TPredicate>, &simd::ScanRange<TPredicate>};
+#if defined(KOLIBRI_LEXER_SSE2)
+  result.push_back(&simd::ScanRangeSse2<TPredicate>);
+#endif
+#if defined(KOLIBRI_LEXER_AVX2)
+  if (__builtin_cpu_supports("avx2")) {
+    result.push_back(&simd::ScanRangeAvx2<TPredicate>);
+  }
+#endif
+  return result;
+}
+
+TEST(SimdTest, ScanRangeStopsAtEveryByte) {
+  for (auto scan_range : ScanRangeImplementations<IsLetterOrDigit>()) {
+    for (unsigned stop = 0; stop < 256; ++stop) {
+      string test_str;
+      for (unsigned i = 0; i < 70; ++i) {
+        test_str.push_back("aZ09mQ"[i % 6]);
+      }
+      test_str[41] = static_cast<char>(stop);
+      const char* begin = test_str.data();
+      const char* expected = IsLetterOrDigit()(static_cast<char>(stop)) ? begin + test_str.size() : begin + 41;
+      EXPECT_EQ(scan_range(begin, begin + test_str.size()), expected) << "stop byte " << stop;
+    }
+  }
+}
+
+TEST(SimdTest, ScanRangeAtEveryLength) {
+  for (auto scan_range : ScanRangeImplementations<IsDigit>()) {
+    for (size_t len = 0; len < 100; ++len) {
+      string test_str = string(len, '7') + "x";
+      const char* begin = test_str.data();
+      EXPECT_EQ(scan_range(begin, begin + test_str.size()), begin + len);
+      EXPECT_EQ(scan_range(begin, begin + len), begin + len);
+    }
+  }
+}
+
+TEST(SimdTest, MatcherSimdRangeByPredicateMatchesLikeMatcherRangeByPredicate) {
+  MatcherSimdRangeByPredicate<IsLetterOrDigit> simd_matcher;
+  MatcherRangeByPredicate<IsLetterOrDigit> matcher;
+  string test_str = string(50, 'q') + "5_";
+  const char* begin = test_str.data();
+  const char* end = begin + test_str.size();
+  EXPECT_EQ(simd_matcher.Parse(begin, end), matcher.Parse(begin, end));
+}
@@ -0,0 +1,146 @@
+#include "lexer/lexer_stream.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "languages/calc/calc_lexer.h"
+#include "languages/pascal/pascal_lexer.h"
+#include "token_out.h"
+
+using namespace lexer;
+using namespace languages::pascal;
+using namespace std;
+
+namespace {
+
+const char* kPascalProgram =
+    "PROGRAM Part10;\n"
+    "VAR\n"
+    "   number     : INTEGER;\n"
+    "   a, b, c, x : INTEGER;\n"
+    "   y          : REAL;\n"
+    "{ a comment which is longer than the chunks used by the tests }\n"
+    "BEGIN {Part10}\n"
+    "   BEGIN\n"
+    "      number := 2;\n"
+    "      a := number;\n"
+    "      averyveryveryverylongidentifier := 10 * a + 10 * number DIV 4;\n"
+    "      c := a - - b\n"
+    "   END;\n"
+    "   x := 11;\n"
+    "   y := 20 / 7 + 3.14159;\n"
+    "END.  {Part10}";
+
+vector<string> LexWhole(const string& input) {
+  vector<string> tokens;
+  PascalDfaLexer lexer(input.data(), input.size());
+  for (auto it = lexer.begin(); it != lexer.end(); ++it) {
+    stringstream ss;
+    ss << *it;
+    tokens.push_back(ss.str());
+  }
+  return tokens;
+}
+
+vector<string> LexStream(const string& input, size_t chunk_size, size_t max_token_length = PascalStreamLexer::kDefaultMaxTokenLength) {
+  vector<string> tokens;
+  istringstream stream(input);
+  PascalStreamLexer lexer(stream, chunk_size, max_token_length);
+  while (true) {
+    auto pinned = lexer.Next();
+    if (lexer.AtEnd()) {
+      break;
+    }
+    stringstream ss;
+    ss << pinned.token;
+    tokens.push_back(ss.str());
+  }
+  return tokens;
+}
+
+}  // namespace
+
+TEST(StreamLexerTest, SameTokensForEveryChunkSize) {
+  auto expected = LexWhole(kPascalProgram);
+  for (size_t chunk_size : {1, 2, 3, 5, 7, 16, 64, 4096}) {
+    EXPECT_EQ(LexStream(kPascalProgram, chunk_size), expected) << "chunk size " << chunk_size;
+  }
+}
+
+TEST(StreamLexerTest, UnterminatedComment) {
+  string input = "a { b c";
+  auto expected = LexWhole(input);
+  EXPECT_EQ(LexStream(input, 2), expected);
+}
+
+TEST(StreamLexerTest, EmptyInput) {
+  istringstream stream("");
+  PascalStreamLexer lexer(stream, 4);
+  auto pinned = lexer.Next();
+  EXPECT_TRUE(lexer.AtEnd());
+  EXPECT_EQ(pinned.token.GetId(), PascalTokenId::kEndOfFile);
+}
+
+TEST(StreamLexerTest, TokensOutliveLexer) {
+  vector<PascalStreamLexer::value_type> tokens;
+  {
+    istringstream stream("first second third");
+    PascalStreamLexer lexer(stream, 4);
+    for (int i = 0; i < 3; ++i) {
+      tokens.push_back(lexer.Next());
+    }
+  }
+  EXPECT_EQ(tokens[0].token.GetValue(), "first");
+  EXPECT_EQ(tokens[1].token.GetValue(), "second");
+  EXPECT_EQ(tokens[2].token.GetValue(), "third");
+}
+
+TEST(StreamLexerTest, LongTokensAreCutAtMaxTokenLength) {
+  istringstream stream(string(100, 'a') + " b");
+  PascalStreamLexer lexer(stream, 8, 32);
+  auto pinned = lexer.Next();
+  EXPECT_EQ(pinned.token.GetId(), PascalTokenId::kUnknown);
+  EXPECT_LT(pinned.token.GetValue().size(), 100u);
+  EXPECT_GE(pinned.token.GetValue().size(), 32u);
+
+  // the rest of the token isn't lexed as tokens of its own
+  pinned = lexer.Next();
+  EXPECT_EQ(pinned.token.GetId(), PascalTokenId::kId);
+  EXPECT_EQ(pinned.token.GetValue(), "b");
+  lexer.Next();
+  EXPECT_TRUE(lexer.AtEnd());
+}
+
+TEST(StreamLexerTest, CommentsLongerThanMaxTokenLengthAreSkipped) {
+  string input = "a { " + string(60, 'x') + " BEGIN } b";
+  EXPECT_EQ(LexStream(input, 8, 32), (vector<string>{"Token(ID, a)", "Token(ID, b)"}));
+  EXPECT_EQ(LexStream(input, 8, 32), LexWhole(input));
+}
+
+TEST(StreamLexerTest, UnterminatedCommentLongerThanMaxTokenLength) {
+  string input = "a { " + string(60, 'x') + " BEGIN b";
+  auto tokens = LexStream(input, 8, 32);
+  ASSERT_EQ(tokens.size(), 2u);
+  EXPECT_EQ(tokens[0], "Token(ID, a)");
+  EXPECT_EQ(tokens[1].rfind("Token(UNKNOWN, { xxx", 0), 0u);
+}
+
+TEST(StreamLexerTest, CalcReader) {
+  string input = "12 + (3*4)";
+  size_t pos = 0;
+  // a reader which hands out one byte per call
+  languages::calc::CalcStreamLexer lexer([&](char* buffer, size_t /*len*/) -> size_t {
+    if (pos == input.size()) {
+      return 0;
+    }
+    buffer[0] = input[pos++];
+    return 1;
+  });
+  auto pinned = lexer.Next();
+  EXPECT_EQ(pinned.token.GetValue(), "12");
+  pinned = lexer.Next();
+  EXPECT_EQ(pinned.token.GetValue(), "+");
+}
@@ -0,0 +1,157 @@
+#include "lexer/lexer_utf8.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "languages/pascal/pascal_lexer.h"
+#include "lexer/lexer_predicates.h"
+#include "lexer/lexer_rules.h"
+
+using namespace lexer;
+using namespace std;
+
+namespace {
+
+vector<utf8::ValidateFunction> ValidateImplementations() {
+  vector<utf8::ValidateFunction> result = {&utf8::ValidateScalar, &utf8::Validate};
+#if defined(KOLIBRI_LEXER_SSE2)
+  result.push_back(&utf8::ValidateSse2);
+#endif
+#if defined(KOLIBRI_LEXER_AVX2)
+  if (__builtin_cpu_supports("avx2")) {
+    result.push_back(&utf8::ValidateAvx2);
+  }
+#endif
+  return result;
+}
+
+size_t InvalidAt(const string& input, utf8::ValidateFunction validate) { return validate(input.data(), input.data() + input.size()) - input.data(); }
+
+using IdMatcher = MatcherUtf8Identifier<PredicateOr<IsLetter, IsChar<'_'>>, IsLetterOrDigit>;
+
+size_t IdLength(const string& input) {
+  IdMatcher matcher;
+  return matcher.Parse(input.data(), input.data() + input.size()) - input.data();
+}
+
+template <typename TLexer>
+vector<typename TLexer::value_type> Tokenize(const string& input) {
+  vector<typename TLexer::value_type> tokens;
+  TLexer lexer(input.data(), input.size());
+  for (auto it = lexer.begin(); it != lexer.end(); ++it) {
+    tokens.push_back(*it);
+  }
+  return tokens;
+}
+
+}  // namespace
+
+TEST(Utf8Test, Decode) {
+  auto decode = [](const string& input) { return utf8::Decode(input.data(), input.data() + input.size()); };
+  EXPECT_EQ(decode("a").code_point, 0x61u);
+  EXPECT_EQ(decode("\xC3\xA4").code_point, 0xE4u);  // ä
+  EXPECT_EQ(decode("\xC3\xA4").length, 2u);
+  EXPECT_EQ(decode("\xE2\x82\xAC").code_point, 0x20ACu);  // €
+  EXPECT_EQ(decode("\xF0\x9F\x98\x80").code_point, 0x1F600u);
+  EXPECT_EQ(decode("\xF0\x9F\x98\x80").length, 4u);
+
+  EXPECT_EQ(decode("").length, 0u);
+  EXPECT_EQ(decode("\x80").length, 0u);              // stray continuation byte
+  EXPECT_EQ(decode("\xC0\xAF").length, 0u);          // overlong
+  EXPECT_EQ(decode("\xE0\x80\xAF").length, 0u);      // overlong
+  EXPECT_EQ(decode("\xED\xA0\x80").length, 0u);      // surrogate
+  EXPECT_EQ(decode("\xF4\x90\x80\x80").length, 0u);  // above U+10FFFF
+  EXPECT_EQ(decode("\xE2\x82").length, 0u);          // cut off
+  EXPECT_EQ(decode("\xE2\x41\xAC").length, 0u);      // no continuation byte
+}
+
+TEST(Utf8Test, ValidateFindsFirstInvalidSequence) {
+  for (auto validate : ValidateImplementations()) {
+    EXPECT_EQ(InvalidAt("", validate), 0u);
+    EXPECT_EQ(InvalidAt("plain ascii", validate), 11u);
+    EXPECT_EQ(InvalidAt("gr\xC3\xB6\xC3\x9F" "e \xE2\x82\xAC", validate), 11u);
+
+    string block(40, 'a');
+    EXPECT_EQ(InvalidAt(block + "\xFF" + block, validate), 40u);
+
+    // a sequence which crosses a block boundary
+    string crossing = string(15, 'a') + "\xE2\x82\xAC" + string(40, 'b');
+    EXPECT_EQ(InvalidAt(crossing, validate), crossing.size());
+    crossing[16] = 'x';
+    EXPECT_EQ(InvalidAt(crossing, validate), 15u);
+
+    // cut off at the end of the buffer
+    EXPECT_EQ(InvalidAt(string(31, 'a') + "\xF0\x9F\x98", validate), 31u);
+  }
+}
+
+TEST(Utf8Test, ValidateImplementationsAgree) {
+  mt19937 rng(7);
+  const char* pieces[] = {"a", " ", "\xC3\xA4", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\x80", "\xC3", "\xED\xA0\x80"};
+  for (int round = 0; round < 500; ++round) {
+    string input;
+    int num_pieces = static_cast<int>(rng() % 80);
+    for (int i = 0; i < num_pieces; ++i) {
+      // mostly valid pieces, so that the invalid ones are found at all positions
+      input += pieces[(rng() % 16 == 0) ? 5 + rng() % 3 : rng() % 5];
+    }
+    size_t expected = InvalidAt(input, &utf8::ValidateScalar);
+    for (auto validate : ValidateImplementations()) {
+      EXPECT_EQ(InvalidAt(input, validate), expected) << input;
+    }
+  }
+}
+
+TEST(Utf8Test, IdentifierClasses) {
+  EXPECT_TRUE(utf8::IsIdentifierStart(0xE4));     // ä
+  EXPECT_TRUE(utf8::IsIdentifierStart(0x3B1));    // α
+  EXPECT_TRUE(utf8::IsIdentifierStart(0x4E2D));   // 中
+  EXPECT_FALSE(utf8::IsIdentifierStart(0xD7));    // ×
+  EXPECT_FALSE(utf8::IsIdentifierStart(0x2260));  // ≠
+  EXPECT_FALSE(utf8::IsIdentifierStart(0x3000));  // ideographic space
+  EXPECT_FALSE(utf8::IsIdentifierStart(0x301));   // combining acute accent
+  EXPECT_TRUE(utf8::IsIdentifierContinue(0x301));
+}
+
+TEST(Utf8Test, MatcherUtf8Identifier) {
+  EXPECT_EQ(IdLength("abc1 d"), 4u);
+  EXPECT_EQ(IdLength("gr\xC3\xB6\xC3\x9F" "e:=1"), 7u);    // größe
+  EXPECT_EQ(IdLength("\xC3\xA4x"), 3u);                    // äx
+  EXPECT_EQ(IdLength("x\xE2\x89\xA0y"), 1u);               // x≠y
+  EXPECT_EQ(IdLength("\xE2\x89\xA0y"), 0u);                // ≠y
+  EXPECT_EQ(IdLength("\xCC\x81" "a"), 0u);                 // combining mark at the start
+  EXPECT_EQ(IdLength("a\xCC\x81"), 3u);                    // combining mark inside
+  EXPECT_EQ(IdLength("1abc"), 0u);
+  EXPECT_EQ(IdLength("a\xC3"), 1u);                        // cut off sequence
+  EXPECT_EQ(IdLength(string(40, 'a') + "\xC3\xA4" + string(40, 'b')), 82u);
+}
+
+TEST(Utf8Test, PascalUtf8Lexer) {
+  using namespace languages::pascal;
+  string input = "VAR gr\xC3\xB6\xC3\x9F" "e : INTEGER; { \xE2\x89\xA0 \xF0\x9F\x98\x80 Kommentar }\nBEGIN \xCE\xB1 := 1 END.";
+  ASSERT_TRUE(utf8::IsValid(input.data(), input.data() + input.size()));
+
+  auto tokens = Tokenize<PascalUtf8Lexer>(input);
+  ASSERT_EQ(tokens.size(), 11u);
+  EXPECT_EQ(tokens[1].GetId(), PascalTokenId::kId);
+  EXPECT_EQ(tokens[1].GetValue(), "gr\xC3\xB6\xC3\x9F" "e");
+  EXPECT_EQ(tokens[5].GetId(), PascalTokenId::kBegin);
+  EXPECT_EQ(tokens[6].GetId(), PascalTokenId::kId);
+  EXPECT_EQ(tokens[6].GetValue(), "\xCE\xB1");
+
+  // the ASCII lexer only fails on the identifiers, the comment is skipped by both
+  auto ascii_tokens = Tokenize<PascalLexer>(input);
+  EXPECT_EQ(ascii_tokens.size(), 17u);
+  EXPECT_EQ(ascii_tokens[3].GetId(), PascalTokenId::kUnknown);
+}
+
+TEST(Utf8Test, PascalUtf8LexerEqualsAsciiLexerOnAscii) {
+  using namespace languages::pascal;
+  string input = "PROGRAM Part10;\nVAR\n   number : INTEGER;\nBEGIN\n  a := NumBer div 4; { comment } _x1 := 3.14\nEND.";
+  auto expected = Tokenize<PascalLexer>(input);
+  auto actual = Tokenize<PascalUtf8Lexer>(input);
+  EXPECT_EQ(expected, actual);
+}
@@ -0,0 +1,202 @@
+#include "parser/parser_ll1_grammar.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "languages/calc/calc_lexer.h"
+#include "languages/calc/calc_parser.h"
+#include "languages/pascal/pascal_lexer.h"
+#include "languages/pascal/pascal_parser.h"
+#include "parser/parser.h"
+#include "parser/parser_productions.h"
+#include "recording_parser_factory.h"
+
+using namespace parser;
+using namespace std;
+
+//----------------------------------------------------------------------------
+// LL(1) check
+//----------------------------------------------------------------------------
+enum class MockLL1TokenId { kA, kB, kC };
+
+template <MockLL1TokenId Id>
+struct MockLL1Predicate {
+  static constexpr MockLL1TokenId kId = Id;
+};
+
+struct MockLL1PredicateWithoutId {};
+
+using A = TermExpr<MockLL1Predicate<MockLL1TokenId::kA>>;
+using B = TermExpr<MockLL1Predicate<MockLL1TokenId::kB>>;
+using C = TermExpr<MockLL1Predicate<MockLL1TokenId::kC>>;
+
+// rule0 : A B | C rule0 | empty
+static_assert(FindLL1Conflicts<OrderedChoiceRules<Rule<TermProduction, SequenceExpr<A, B>>,              //
+                                                  Rule<TermProduction, SequenceExpr<C, NonTermExpr<RuleId::kRule0>>>,  //
+                                                  Rule<EmptyProduction, EmptyExpr>>>()
+                  .count == 0);
+
+TEST(LL1ConflictsTest, AlternativesStartingWithTheSameToken) {
+  // rule0 : B | rule1 C
+  // rule1 : A | B
+  constexpr auto conflicts = FindLL1Conflicts<OrderedChoiceRules<Rule<TermProduction, B>, Rule<TermProduction, SequenceExpr<NonTermExpr<RuleId::kRule1>, C>>>,
+                                              Rule<TermProduction, OrderedChoiceExpr<A, B>>>();
+  ASSERT_EQ(conflicts.count, 1u);
+  EXPECT_EQ(conflicts.conflicts[0].kind, LL1ConflictKind::kFirstFirst);
+  EXPECT_EQ(conflicts.conflicts[0].rule, RuleId::kRule0);
+  EXPECT_EQ(conflicts.conflicts[0].token_id, static_cast<unsigned>(MockLL1TokenId::kB));
+}
+
+TEST(LL1ConflictsTest, RepetitionFollowedByItsFirstToken) {
+  // rule0 : A* A
+  constexpr auto conflicts = FindLL1Conflicts<Rule<TermProduction, SequenceExpr<NMatchesOrMoreExpr<0, A>, A>>>();
+  ASSERT_EQ(conflicts.count, 1u);
+  EXPECT_EQ(conflicts.conflicts[0].kind, LL1ConflictKind::kFirstFollow);
+  EXPECT_EQ(conflicts.conflicts[0].token_id, static_cast<unsigned>(MockLL1TokenId::kA));
+}
+
+TEST(LL1ConflictsTest, EmptyAlternativeFollowedByTheFirstTokenOfAnother) {
+  // rule0 : (A | empty) A
+  constexpr auto conflicts = FindLL1Conflicts<Rule<TermProduction, SequenceExpr<OrderedChoiceExpr<A, EmptyExpr>, A>>>();
+  ASSERT_EQ(conflicts.count, 1u);
+  EXPECT_EQ(conflicts.conflicts[0].kind, LL1ConflictKind::kFirstFollow);
+}
+
+TEST(LL1ConflictsTest, PredicatesWithoutTokenId) {
+  constexpr auto conflicts = FindLL1Conflicts<Rule<TermProduction, SequenceExpr<A, TermExpr<MockLL1PredicateWithoutId>>>>();
+  EXPECT_GE(conflicts.count, 1u);
+  EXPECT_EQ(conflicts.conflicts[0].kind, LL1ConflictKind::kUnknownToken);
+}
+
+TEST(LL1ConflictsTest, OperatorFollowingThePrecedenceExpression) {
+  // rule0 : A (B A)* B
+  constexpr auto conflicts =
+      FindLL1Conflicts<Rule<TermProduction, SequenceExpr<PrecedenceExpr<A, BinaryOperator<RuleId::kRule0, MockLL1Predicate<MockLL1TokenId::kB>, 1>>, B>>>();
+  ASSERT_EQ(conflicts.count, 1u);
+  EXPECT_EQ(conflicts.conflicts[0].kind, LL1ConflictKind::kFirstFollow);
+  EXPECT_EQ(conflicts.conflicts[0].token_id, static_cast<unsigned>(MockLL1TokenId::kB));
+}
+
+TEST(LL1ConflictsTest, LanguagesAreLL1) {
+  EXPECT_EQ(languages::calc::CalcLL1Grammar::kTables.conflicts.count, 0u);
+  EXPECT_EQ(languages::pascal::PascLL1Grammar::kTables.conflicts.count, 0u);
+}
+
+//----------------------------------------------------------------------------
+// LL1ParserGrammar Tests
+//----------------------------------------------------------------------------
+template <template <typename...> class TParserGrammar>
+using CalcStringGrammar = typename languages::calc::CalculatorGrammar<string, base::TokenBuffer<languages::calc::CalcToken>::iterator_type, TParserGrammar>::type;
+
+template <template <typename...> class TParserGrammar>
+using PascalStringGrammar =
+    typename languages::pascal::PascalGrammar<string, base::TokenBuffer<languages::pascal::PascalToken>::iterator_type, TParserGrammar>::type;
+
+template <typename TGrammar, typename TLexer>
+typename Parser<TGrammar>::ExprResult Parse(RecordingParserFactory<typename TLexer::value_type>& parser_factory, const string& input) {
+  TLexer lexer(input.data(), input.size());
+  Parser<TGrammar> parser(parser_factory);
+  return parser.Expr(lexer.begin(), lexer.end());
+}
+
+class LL1ParserGrammarCalcTest : public ::testing::TestWithParam<const char*> {};
+
+TEST_P(LL1ParserGrammarCalcTest, SameNodesAsParserGrammar) {
+  using languages::calc::CalcLexer;
+  RecordingParserFactory<languages::calc::CalcToken> parser_factory;
+  auto expected = Parse<CalcStringGrammar<ParserGrammar>, CalcLexer>(parser_factory, GetParam());
+  auto actual = Parse<CalcStringGrammar<LL1ParserGrammar>, CalcLexer>(parser_factory, GetParam());
+  EXPECT_FALSE(expected.is_error);
+  EXPECT_FALSE(actual.is_error);
+  EXPECT_EQ(expected.node, actual.node);
+}
+
+INSTANTIATE_TEST_SUITE_P(Inputs, LL1ParserGrammarCalcTest,
+                         ::testing::Values("1", "-1+2", "5+5*6+(4+2)+(50 * 60)-1", "((((((((2))))))))*-(3-+4)", "2*(3+4)*(5-(6/2))",
+                                           "8/4/2-1-1*2*3+-4*(5+6)/7"));
+
+TEST(LL1ParserGrammarTest, PascalSameNodesAsParserGrammar) {
+  using languages::pascal::PascalLexer;
+  const char* program =
+      "PROGRAM Part10;\n"
+      "VAR\n"
+      "   number     : INTEGER;\n"
+      "   a, b, c, x : INTEGER;\n"
+      "   y          : REAL;\n"
+      "BEGIN {Part10}\n"
+      "   BEGIN\n"
+      "      number := 2;\n"
+      "      a := number;\n"
+      "      b := 10 * a + 10 * number DIV 4;\n"
+      "      c := a - - b\n"
+      "   END;\n"
+      "   x := 11;\n"
+      "   y := 20 / 7 + 3.14;\n"
+      "   ;\n"
+      "END.  {Part10}";
+  RecordingParserFactory<languages::pascal::PascalToken> parser_factory;
+  auto expected = Parse<PascalStringGrammar<ParserGrammar>, PascalLexer>(parser_factory, program);
+  auto actual = Parse<PascalStringGrammar<LL1ParserGrammar>, PascalLexer>(parser_factory, program);
+  EXPECT_FALSE(expected.is_error);
+  EXPECT_FALSE(actual.is_error);
+  EXPECT_EQ(expected.node, actual.node);
+}
+
+// rule0 : rule1 (('+' | '*') rule1)* where '*' binds stronger and is right associative
+// rule1 : INTEGER
+template <template <typename...> class TParserGrammar>
+using RightAssociativeGrammar = TParserGrammar<
+    string, base::TokenBuffer<languages::calc::CalcToken>::iterator_type,
+    Rule<BypassLastTermProduction,
+         PrecedenceExpr<NonTermExpr<RuleId::kRule1>,                                                                                           //
+                        BinaryOperator<RuleId::kRule0, languages::calc::CalcTokenPredicate<languages::calc::CalcTokenId::kPlus>, 1>,           //
+                        BinaryOperator<RuleId::kRule1, languages::calc::CalcTokenPredicate<languages::calc::CalcTokenId::kMultiply>, 2,        //
+                                       Associativity::kRight>>>,
+    Rule<TermProduction, TermExpr<languages::calc::CalcTokenPredicate<languages::calc::CalcTokenId::kInteger>>>>;
+
+TEST(LL1ParserGrammarTest, RightAssociativeOperators) {
+  using languages::calc::CalcLexer;
+  RecordingParserFactory<languages::calc::CalcToken> parser_factory;
+  auto expected = Parse<RightAssociativeGrammar<ParserGrammar>, CalcLexer>(parser_factory, "1*2*3+4*5+6");
+  auto actual = Parse<RightAssociativeGrammar<LL1ParserGrammar>, CalcLexer>(parser_factory, "1*2*3+4*5+6");
+  EXPECT_EQ(expected.node, "(0 (0 (1 1 * (1 2 * 3)) + (1 4 * 5)) + 6)");
+  EXPECT_EQ(actual.node, expected.node);
+}
+
+TEST(LL1ParserGrammarTest, ErrorIsReportedAtTheTokenWhichDoesntFit) {
+  using languages::calc::CalcLexer;
+  RecordingParserFactory<languages::calc::CalcToken> parser_factory;
+  string input = "1 + * 2";
+  auto result = Parse<CalcStringGrammar<LL1ParserGrammar>, CalcLexer>(parser_factory, input);
+  EXPECT_TRUE(result.is_error);
+  EXPECT_EQ(result.node, "null");
+  EXPECT_EQ(result.error_position, input.data() + 4);
+}
+
+TEST(LL1ParserGrammarTest, UnexpectedEnd) {
+  using languages::calc::CalcLexer;
+  RecordingParserFactory<languages::calc::CalcToken> parser_factory;
+  auto result = Parse<CalcStringGrammar<LL1ParserGrammar>, CalcLexer>(parser_factory, "(1+");
+  EXPECT_TRUE(result.is_error);
+  EXPECT_STREQ(result.error_msg, "ERROR: Unexpected END");
+}
+
+TEST(LL1ParserGrammarTest, TokensLeft) {
+  using languages::calc::CalcLexer;
+  RecordingParserFactory<languages::calc::CalcToken> parser_factory;
+  auto result = Parse<CalcStringGrammar<LL1ParserGrammar>, CalcLexer>(parser_factory, "1 2");
+  EXPECT_TRUE(result.is_error);
+  EXPECT_STREQ(result.error_msg, "ERROR: Tokens left");
+}
+
+TEST(LL1ParserGrammarTest, DeepNestingDoesntUseTheCallStack) {
+  using languages::calc::CalcLexer;
+  RecordingParserFactory<languages::calc::CalcToken> parser_factory;
+  const size_t depth = 100000;  // far beyond what the recursive ParserGrammar can handle
+  string input = string(depth, '(') + "1" + string(depth, ')');
+  auto result = Parse<CalcStringGrammar<LL1ParserGrammar>, CalcLexer>(parser_factory, input);
+  EXPECT_FALSE(result.is_error);
+  EXPECT_EQ(result.node, "1");
+}
@@ -8,6 +8,8 @@
 #include <string>
 #include <string_view>
 
+#include "recording_parser_factory.h"
+
 using namespace parser;
 using namespace std;
 
@@ -62,4 +64,33 @@ TEST_F(EmptyProductionTest, Create) {
 
   auto res = nop_production.Create(mock_parser_factory_);
   EXPECT_EQ(res, "");
-}
\ No newline at end of file
+}
+//----------------------------------------------------------------------------
+// StaticParserFactory Test
+//----------------------------------------------------------------------------
+
+// A token type of its own, MockToken is defined differently by other tests.
+struct MockStaticToken {
+  std::string value;
+  std::string_view GetValue() const { return value; }
+};
+
+TEST(StaticParserFactoryTest, ProductionPassesRuleIdConstant) {
+  RecordingParserFactory<MockStaticToken> parser_factory;
+  NonTermProduction<NonTermType, MockStaticToken> production(RuleId::kRule0);
+  production.AddNonTerminal("a");
+
+  EXPECT_EQ(production.Create(parser_factory), "(0 a)");
+  EXPECT_EQ(production.Create(parser_factory, RuleIdConstant<RuleId::kRule3>()), "(#3 a)");
+}
+
+TEST(StaticParserFactoryTest, InterfaceCallsTheTemplates) {
+  RecordingParserFactory<MockStaticToken> parser_factory;
+  IParserFactory<NonTermType, MockStaticToken>& interface = parser_factory;
+
+  EXPECT_EQ(interface.CreateNull(), "null");
+  EXPECT_EQ(interface.CreateEmpty(RuleId::kRule1), "empty1");
+  EXPECT_EQ(interface.CreateTerm(RuleId::kRule2, MockStaticToken{"b"}), "b");
+  EXPECT_EQ(interface.CreateTermNonTerm(RuleId::kRule2, MockStaticToken{"b"}, "c"), "(2 b c)");
+  EXPECT_EQ(interface.CreateNonTermList(RuleId::kRule4, {}), "(4)");
+}
@@ -7,6 +7,10 @@
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <vector>
+
+#include "parser/parser_productions.h"
+#include "recording_parser_factory.h"
 
 using namespace parser;
 using namespace std;
@@ -621,3 +625,362 @@ TEST_F(OptionalExprTest, Match) {
   EXPECT_EQ(result.is_error, false);
   EXPECT_EQ(result.msg, "");
 }
+
+//----------------------------------------------------------------------------
+// class PackratParserGrammar Test
+//----------------------------------------------------------------------------
+template <char C>
+struct CountingTokenPredicate {
+  static inline unsigned calls = 0;
+
+  bool operator()(const MockToken& token) {
+    calls++;
+    return token == string(1, C);
+  }
+};
+
+// rule0 : rule1 'x' | rule1 'y'
+// rule1 : '(' rule0 ')' | '1'
+// Without memoization every rule0 parses its rule1 twice, i.e. the work doubles with each level.
+template <template <typename...> class TParserGrammar>
+using BacktrackingGrammar = TParserGrammar<
+    NonTermType, MockIterator,
+    OrderedChoiceRules<Rule<BypassLastTermProduction, SequenceExpr<NonTermExpr<RuleId::kRule1>, TermExpr<CountingTokenPredicate<'x'>>>>,
+                       Rule<BypassLastTermProduction, SequenceExpr<NonTermExpr<RuleId::kRule1>, TermExpr<CountingTokenPredicate<'y'>>>>>,
+    OrderedChoiceRules<Rule<BypassLastTermProduction, SequenceExpr<TermExpr<CountingTokenPredicate<'('>>, NonTermExpr<RuleId::kRule0>,
+                                                                   TermExpr<CountingTokenPredicate<')'>>>>,
+                       Rule<TermProduction, TermExpr<CountingTokenPredicate<'1'>>>>>;
+
+class PackratParserGrammarTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ON_CALL(parser_factory, CreateTerm).WillByDefault([](RuleId, MockToken term) { return "term:" + term; });
+    // ((...(1y)y...)y)y
+    test_data = {"1", "y"};
+    for (int i = 0; i < 12; ++i) {
+      test_data.insert(test_data.begin(), "(");
+      test_data.push_back(")");
+      test_data.push_back("y");
+    }
+  }
+
+  template <template <typename...> class TParserGrammar>
+  RuleResult<NonTermType> Parse(unsigned& leaf_calls, MockIterator& it) {
+    BacktrackingGrammar<TParserGrammar> grammar;
+    grammar.Reset();
+    CountingTokenPredicate<'1'>::calls = 0;
+    it = test_data.begin();
+    auto result = grammar.Match(parser_factory, RuleId::kRule0, it, test_data.end());
+    leaf_calls = CountingTokenPredicate<'1'>::calls;
+    return result;
+  }
+
+ public:
+  vector<MockToken> test_data;
+  ::testing::NiceMock<MockParserFactory> parser_factory;
+};
+
+TEST_F(PackratParserGrammarTest, SameResultAsWithoutMemoization) {
+  unsigned plain_calls = 0;
+  MockIterator plain_it;
+  auto plain = Parse<ParserGrammar>(plain_calls, plain_it);
+
+  unsigned packrat_calls = 0;
+  MockIterator packrat_it;
+  auto packrat = Parse<PackratParserGrammar>(packrat_calls, packrat_it);
+
+  EXPECT_TRUE(plain.is_match);
+  EXPECT_EQ(plain_it, test_data.end());
+  EXPECT_EQ(plain.node, "term:1");
+
+  EXPECT_EQ(packrat.is_match, plain.is_match);
+  EXPECT_EQ(packrat.is_error, plain.is_error);
+  EXPECT_EQ(packrat.node, plain.node);
+  EXPECT_EQ(packrat_it, plain_it);
+
+  EXPECT_GT(plain_calls, 4096u);  // exponential in the nesting depth
+  EXPECT_EQ(packrat_calls, 1u);   // the innermost rule1 is parsed once
+}
+
+TEST_F(PackratParserGrammarTest, NoMatchIsRemembered) {
+  test_data.back() = "x";  // only the outermost rule1 is parsed twice
+  unsigned packrat_calls = 0;
+  MockIterator it;
+  auto result = Parse<PackratParserGrammar>(packrat_calls, it);
+  EXPECT_TRUE(result.is_match);
+  EXPECT_EQ(packrat_calls, 1u);
+
+  test_data.back() = "z";  // the outermost rule0 fails with both alternatives
+  result = Parse<PackratParserGrammar>(packrat_calls, it);
+  EXPECT_FALSE(result.is_match);
+  EXPECT_EQ(it, test_data.begin());
+  EXPECT_EQ(packrat_calls, 1u);
+}
+
+//----------------------------------------------------------------------------
+// Static rule dispatch Test
+//----------------------------------------------------------------------------
+class MockStaticDispatchGrammar : public MockParserGrammar, public StaticDispatchGrammarTag {
+ public:
+  template <RuleId RId>
+  RuleResult<NonTermType> MatchRule(IParserFactory<NonTermType, string>& factory, MockIterator& it, MockIterator end) {
+    called_rule = RId;
+    ++it;
+    return RuleResult<NonTermType>(true, "static", false, "");
+  }
+
+  RuleId called_rule = RuleId::kRule0;
+};
+
+class MockNonTermProduction {
+ public:
+  MOCK_METHOD1(AddNonTerminal, void(NonTermType nonterm));
+};
+
+TEST(NonTermExprTest, CallsRuleOfStaticDispatchGrammarDirectly) {
+  vector<string> test_data = {"a", "b"};
+  auto it = test_data.begin();
+  MockParserFactory parser_factory;
+  MockStaticDispatchGrammar grammar;
+  MockNonTermProduction production;
+
+  EXPECT_CALL(grammar, Match).Times(0);  // no virtual call
+  EXPECT_CALL(production, AddNonTerminal("static")).Times(1);
+
+  NonTermExpr<RuleId::kRule13> expr;
+  auto result = expr.Match(production, parser_factory, grammar, it, test_data.end());
+
+  EXPECT_TRUE(result.is_match);
+  EXPECT_EQ(grammar.called_rule, RuleId::kRule13);
+  EXPECT_EQ(it, test_data.begin() + 1);
+}
+
+TEST(NonTermExprTest, CallsVirtualMatchOfOtherGrammars) {
+  vector<string> test_data = {"a", "b"};
+  auto it = test_data.begin();
+  MockParserFactory parser_factory;
+  MockParserGrammar grammar;
+  MockNonTermProduction production;
+
+  EXPECT_CALL(grammar, Match(_, RuleId::kRule13, _, _)).Times(1).WillOnce(Return(RuleResult<NonTermType>(true, "virtual", false, "")));
+  EXPECT_CALL(production, AddNonTerminal("virtual")).Times(1);
+
+  NonTermExpr<RuleId::kRule13> expr;
+  auto result = expr.Match(production, parser_factory, grammar, it, test_data.end());
+  EXPECT_TRUE(result.is_match);
+}
+
+TEST_F(PackratParserGrammarTest, VirtualAndStaticDispatchAgree) {
+  test_data = {"(", "1", "x", ")"};
+  BacktrackingGrammar<ParserGrammar> grammar;
+
+  auto it = test_data.begin();
+  auto dynamic_result = grammar.Match(parser_factory, RuleId::kRule1, it, test_data.end());
+  auto dynamic_end = it;
+
+  it = test_data.begin();
+  auto static_result = grammar.MatchRule<RuleId::kRule1>(parser_factory, it, test_data.end());
+
+  EXPECT_TRUE(static_result.is_match);
+  EXPECT_EQ(static_result.is_match, dynamic_result.is_match);
+  EXPECT_EQ(static_result.node, dynamic_result.node);
+  EXPECT_EQ(it, dynamic_end);
+  EXPECT_EQ(it, test_data.end());
+}
+
+//----------------------------------------------------------------------------
+// FIRST set Test
+//----------------------------------------------------------------------------
+enum class MockTokenId { kA, kB, kC, kD };
+
+struct MockIdToken {
+  MockTokenId id;
+  MockTokenId GetId() const { return id; }
+  std::string_view GetValue() const { return std::string_view("ABCD" + static_cast<int>(id), 1); }
+};
+
+using MockIdIterator = vector<MockIdToken>::iterator;
+
+template <MockTokenId Id>
+struct MockIdPredicate {
+  static constexpr MockTokenId kId = Id;
+  static inline unsigned calls = 0;
+
+  bool operator()(const MockIdToken& token) {
+    calls++;
+    return token.id == Id;
+  }
+};
+
+// rule0 : A B | rule1 | C
+// rule1 : D rule1 | empty
+using FirstSetGrammar = ParserGrammar<NonTermType, MockIdIterator,                                                                    //
+                                      OrderedChoiceRules<                                                                              //
+                                          Rule<TermProduction, SequenceExpr<TermExpr<MockIdPredicate<MockTokenId::kA>>,                //
+                                                                            TermExpr<MockIdPredicate<MockTokenId::kB>>>>,              //
+                                          Rule<BypassLastTermProduction, NonTermExpr<RuleId::kRule1>>,                                 //
+                                          Rule<TermProduction, TermExpr<MockIdPredicate<MockTokenId::kC>>>>,                           //
+                                      OrderedChoiceRules<                                                                              //
+                                          Rule<BypassLastTermProduction, SequenceExpr<TermExpr<MockIdPredicate<MockTokenId::kD>>,      //
+                                                                                      NonTermExpr<RuleId::kRule1>>>,                   //
+                                          Rule<EmptyProduction, EmptyExpr>>>;
+
+static_assert(FirstSetGrammar::kFirstSets[1].ids == (1u << static_cast<unsigned>(MockTokenId::kD)));
+static_assert(FirstSetGrammar::kFirstSets[1].nullable);
+static_assert(FirstSetGrammar::kFirstSets[0].ids == 0b1101);  // A, C and D
+static_assert(FirstSetGrammar::kFirstSets[0].nullable);
+static_assert(!FirstSetGrammar::kFirstSets[0].any);
+
+TEST(FirstSetTest, UnknownPredicatesStartWithAnyToken) {
+  using Grammar = ParserGrammar<NonTermType, MockIterator, Rule<TermProduction, TermExpr<CountingTokenPredicate<'x'>>>>;
+  EXPECT_TRUE(Grammar::kFirstSets[0].any);
+  EXPECT_FALSE(Grammar::kFirstSets[0].nullable);
+}
+
+TEST(FirstSetTest, ChoiceOnlyTriesAlternativesWhichCanStartWithTheToken) {
+  RecordingParserFactory<MockIdToken> parser_factory;
+  FirstSetGrammar grammar;
+  vector<MockIdToken> test_data = {{MockTokenId::kC}};
+
+  MockIdPredicate<MockTokenId::kA>::calls = 0;
+  MockIdPredicate<MockTokenId::kC>::calls = 0;
+  MockIdPredicate<MockTokenId::kD>::calls = 0;
+  auto it = test_data.begin();
+  auto result = grammar.Match(parser_factory, RuleId::kRule0, it, test_data.end());
+
+  // rule1 is nullable and has to be tried, its alternative starting with D doesn't
+  EXPECT_TRUE(result.is_match);
+  EXPECT_EQ(result.node, "empty1");
+  EXPECT_EQ(it, test_data.begin());
+  EXPECT_EQ(MockIdPredicate<MockTokenId::kA>::calls, 0u);
+  EXPECT_EQ(MockIdPredicate<MockTokenId::kD>::calls, 0u);
+
+  MockIdPredicate<MockTokenId::kA>::calls = 0;
+  test_data = {{MockTokenId::kD}, {MockTokenId::kD}, {MockTokenId::kA}};
+  it = test_data.begin();
+  result = grammar.Match(parser_factory, RuleId::kRule0, it, test_data.end());
+  EXPECT_TRUE(result.is_match);
+  EXPECT_EQ(it, test_data.begin() + 2);
+  EXPECT_EQ(MockIdPredicate<MockTokenId::kA>::calls, 0u);
+}
+
+//----------------------------------------------------------------------------
+// Static factory Test
+//----------------------------------------------------------------------------
+
+TEST(StaticParserFactoryTest, GrammarPassesRuleIdConstants) {
+  RecordingParserFactory<MockIdToken> parser_factory;
+  FirstSetGrammar grammar;
+  vector<MockIdToken> test_data = {{MockTokenId::kC}};
+
+  auto it = test_data.begin();
+  auto result = grammar.MatchRule<RuleId::kRule0>(parser_factory, it, test_data.end());
+  EXPECT_TRUE(result.is_match);
+  EXPECT_EQ(result.node, "empty#1");
+
+  // the virtual path converts the constants to RuleIds
+  it = test_data.begin();
+  result = grammar.Match(parser_factory, RuleId::kRule0, it, test_data.end());
+  EXPECT_EQ(result.node, "empty1");
+}
+
+//----------------------------------------------------------------------------
+// PrecedenceExpr Test
+//----------------------------------------------------------------------------
+struct MockPrecedenceToken {
+  MockTokenId id;
+  char value;
+  MockTokenId GetId() const { return id; }
+  std::string_view GetValue() const { return std::string_view(&value, 1); }
+};
+
+using MockPrecedenceIterator = vector<MockPrecedenceToken>::iterator;
+
+template <MockTokenId Id>
+struct MockPrecedencePredicate {
+  static constexpr MockTokenId kId = Id;
+
+  bool operator()(const MockPrecedenceToken& token) { return token.id == Id; }
+};
+
+// rule0 : rule1 (('+' | '*' | '^') rule1)* where '^' binds strongest and is right associative
+// rule1 : A
+using PrecedenceGrammar = ParserGrammar<NonTermType, MockPrecedenceIterator,                                                 //
+                                        Rule<BypassLastTermProduction,                                                        //
+                                             PrecedenceExpr<NonTermExpr<RuleId::kRule1>,                                      //
+                                                            BinaryOperator<RuleId::kRule0, MockPrecedencePredicate<MockTokenId::kB>, 1>,  //
+                                                            BinaryOperator<RuleId::kRule0, MockPrecedencePredicate<MockTokenId::kC>, 2>,  //
+                                                            BinaryOperator<RuleId::kRule0, MockPrecedencePredicate<MockTokenId::kD>, 3,   //
+                                                                           Associativity::kRight>>>,                          //
+                                        Rule<TermProduction, TermExpr<MockPrecedencePredicate<MockTokenId::kA>>>>;
+
+static_assert(PrecedenceGrammar::kFirstSets[0].ids == (1u << static_cast<unsigned>(MockTokenId::kA)));
+static_assert(!PrecedenceGrammar::kFirstSets[0].nullable);
+
+class PrecedenceExprTest : public ::testing::Test {
+ protected:
+  // digits are operands
+  static vector<MockPrecedenceToken> Tokens(const string& input) {
+    vector<MockPrecedenceToken> tokens;
+    for (char c : input) {
+      MockTokenId id = c == '+' ? MockTokenId::kB : c == '*' ? MockTokenId::kC : c == '^' ? MockTokenId::kD : MockTokenId::kA;
+      tokens.push_back({id, c});
+    }
+    return tokens;
+  }
+
+  RuleResult<NonTermType> Parse(const string& input) {
+    tokens_ = Tokens(input);
+    it_ = tokens_.begin();
+    return grammar_.Match(parser_factory_, RuleId::kRule0, it_, tokens_.end());
+  }
+
+  RecordingParserFactory<MockPrecedenceToken> parser_factory_;
+  PrecedenceGrammar grammar_;
+  vector<MockPrecedenceToken> tokens_;
+  MockPrecedenceIterator it_;
+};
+
+TEST_F(PrecedenceExprTest, SingleOperand) {
+  auto result = Parse("1");
+  EXPECT_TRUE(result.is_match);
+  EXPECT_EQ(result.node, "1");
+  EXPECT_EQ(it_, tokens_.end());
+}
+
+TEST_F(PrecedenceExprTest, LeftAssociative) {
+  auto result = Parse("1+2+3+4");
+  EXPECT_TRUE(result.is_match);
+  EXPECT_EQ(result.node, "(0 (0 (0 1 + 2) + 3) + 4)");
+  EXPECT_EQ(it_, tokens_.end());
+}
+
+TEST_F(PrecedenceExprTest, RightAssociative) {
+  auto result = Parse("1^2^3");
+  EXPECT_TRUE(result.is_match);
+  EXPECT_EQ(result.node, "(0 1 ^ (0 2 ^ 3))");
+}
+
+TEST_F(PrecedenceExprTest, HigherPrecedenceBindsStronger) {
+  EXPECT_EQ(Parse("1+2*3+4").node, "(0 (0 1 + (0 2 * 3)) + 4)");
+  EXPECT_EQ(Parse("1*2+3*4").node, "(0 (0 1 * 2) + (0 3 * 4))");
+  EXPECT_EQ(Parse("1*2^3^4*5+6").node, "(0 (0 (0 1 * (0 2 ^ (0 3 ^ 4))) * 5) + 6)");
+}
+
+TEST_F(PrecedenceExprTest, OperatorWithoutOperandIsntConsumed) {
+  auto result = Parse("1+2*");
+  EXPECT_TRUE(result.is_match);
+  EXPECT_EQ(result.node, "(0 1 + 2)");
+  EXPECT_EQ(it_, tokens_.begin() + 3);
+
+  result = Parse("1*+2");
+  EXPECT_TRUE(result.is_match);
+  EXPECT_EQ(result.node, "1");
+  EXPECT_EQ(it_, tokens_.begin() + 1);
+}
+
+TEST_F(PrecedenceExprTest, NoOperand) {
+  auto result = Parse("+1");
+  EXPECT_FALSE(result.is_match);
+  EXPECT_EQ(it_, tokens_.begin());
+}
@@ -0,0 +1,80 @@
+#ifndef KOLIBRI_TESTS_PARSER_RECORDING_PARSER_FACTORY_H_
+#define KOLIBRI_TESTS_PARSER_RECORDING_PARSER_FACTORY_H_
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "parser/i_parser_factory.h"
+
+namespace parser {
+
+// Records every call as a string, so two parsers which call the factory the same way give the
+// same string. Rule ids are written as numbers, ids which were passed as RuleIdConstant get a
+// leading '#'. Terms are written as their value.
+//
+//   CreateEmpty(kRule1)                   -> "empty1"
+//   CreateNonTermTermNonTerm(kRule0, ...) -> "(0 lhs term rhs)"
+template <typename TTerm>
+class RecordingParserFactory final : public StaticParserFactory<RecordingParserFactory<TTerm>, std::string, TTerm> {
+ public:
+  using nonterm_type = std::string;
+  using term_type = TTerm;
+
+  nonterm_type CreateNull() override { return "null"; }
+
+  template <typename TRuleId>
+  nonterm_type CreateEmpty(TRuleId rule_id) {
+    return "empty" + Id(rule_id);
+  }
+  template <typename TRuleId>
+  nonterm_type CreateTerm(TRuleId /*rule_id*/, term_type term) {
+    return Term(term);
+  }
+  template <typename TRuleId>
+  nonterm_type CreateNonTerm(TRuleId rule_id, nonterm_type nonterm) {
+    return "(" + Id(rule_id) + " " + nonterm + ")";
+  }
+  template <typename TRuleId>
+  nonterm_type CreateTermNonTerm(TRuleId rule_id, term_type term, nonterm_type nonterm) {
+    return "(" + Id(rule_id) + " " + Term(term) + " " + nonterm + ")";
+  }
+  template <typename TRuleId>
+  nonterm_type CreateNonTermNonTerm(TRuleId rule_id, nonterm_type lhs, nonterm_type rhs) {
+    return "(" + Id(rule_id) + " " + lhs + " " + rhs + ")";
+  }
+  template <typename TRuleId>
+  nonterm_type CreateNonTermTermNonTerm(TRuleId rule_id, nonterm_type lhs, term_type term, nonterm_type rhs) {
+    return "(" + Id(rule_id) + " " + lhs + " " + Term(term) + " " + rhs + ")";
+  }
+  template <typename TRuleId>
+  nonterm_type CreateNonTermList(TRuleId rule_id, std::vector<nonterm_type> statements) {
+    std::string result = "(" + Id(rule_id);
+    for (auto& statement : statements) {
+      result += " " + statement;
+    }
+    return result + ")";
+  }
+  template <typename TRuleId>
+  nonterm_type CreateTermNonTermList(TRuleId rule_id, std::vector<term_type> terms, std::vector<nonterm_type> nonterms) {
+    std::string result = "(" + Id(rule_id);
+    for (auto& term : terms) {
+      result += " " + Term(term);
+    }
+    for (auto& nonterm : nonterms) {
+      result += " " + nonterm;
+    }
+    return result + ")";
+  }
+
+ private:
+  template <typename TRuleId>
+  static std::string Id(TRuleId rule_id) {
+    std::string id = std::to_string(static_cast<int>(static_cast<RuleId>(rule_id)));
+    return std::is_same<TRuleId, RuleId>::value ? id : "#" + id;
+  }
+  static std::string Term(const term_type& term) { return std::string(term.GetValue()); }
+};
+
+}  // namespace parser
+#endif